@@ -0,0 +1,79 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t heapAllocations = 0;
+
+uint64_t HeapAllocations()
+{
+    return heapAllocations;
+}
+
+static void *CountedAlloc(std::size_t size)
+{
+    ++heapAllocations;
+    void *p = std::malloc(size != 0 ? size : 1u);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void *CountedAlignedAlloc(std::size_t size, std::align_val_t align)
+{
+    ++heapAllocations;
+    const std::size_t alignment = static_cast<std::size_t>(align);
+#if defined(_WIN32)
+    void *p = _aligned_malloc(size != 0 ? size : 1u, alignment);
+#else
+    void *p = nullptr;
+    if (posix_memalign(&p, alignment < sizeof(void *) ? sizeof(void *) : alignment, size != 0 ? size : 1u) != 0)
+    {
+        p = nullptr;
+    }
+#endif
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void AlignedFree(void *p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void *operator new(std::size_t size) { return CountedAlloc(size); }
+void *operator new[](std::size_t size) { return CountedAlloc(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return CountedAlloc(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void *operator new(std::size_t size, std::align_val_t align) { return CountedAlignedAlloc(size, align); }
+void *operator new[](std::size_t size, std::align_val_t align) { return CountedAlignedAlloc(size, align); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Global operator new/delete are replaced in alloc_counter.cpp so every heap
+// allocation bumps a per-thread counter. The count costs one thread-local
+// increment; --check-allocs uses it to prove steady-state frames stay off the
+// heap.
+uint64_t HeapAllocations(); // on the calling thread since it started
@@ -0,0 +1,244 @@
+#include "asset_stream.h"
+
+#include "rlgl.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Rows uploaded per UpdateTextureRec call. A 3200-wide strip is ~1.6 MB,
+// small enough to keep each call well under a millisecond.
+static constexpr int kUploadStripRows = 128;
+
+AssetStreamer::AssetStreamer(size_t budgetBytes) : budget(budgetBytes)
+{
+    worker = std::thread([this]()
+                         { Worker(); });
+}
+
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    for (auto &done : decoded)
+    {
+        UnloadImage(done.image);
+    }
+    for (auto &item : entries)
+    {
+        if (item.second.image.data != nullptr)
+        {
+            UnloadImage(item.second.image);
+        }
+    }
+}
+
+void AssetStreamer::Worker()
+{
+    for (;;)
+    {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]()
+                      { return stopping || !requests.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            path = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        Decoded done;
+        done.path = path;
+        done.image = LoadImage((root + path).c_str());
+        if (done.image.data != nullptr && done.image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+        {
+            ImageFormat(&done.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(std::move(done));
+    }
+}
+
+void AssetStreamer::Request(const std::string &path, bool urgent)
+{
+    const auto it = entries.find(path);
+    if (it != entries.end())
+    {
+        if (urgent && it->second.state == State::Queued)
+        {
+            // Still waiting for the worker: move it to the head of the queue.
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto queued = std::find(requests.begin(), requests.end(), path);
+            if (queued != requests.end() && queued != requests.begin())
+            {
+                requests.erase(queued);
+                requests.push_front(path);
+            }
+        }
+        return;
+    }
+
+    entries.emplace(path, Entry{});
+    ++pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (urgent)
+        {
+            requests.push_front(path);
+        }
+        else
+        {
+            requests.push_back(path);
+        }
+    }
+    wake.notify_one();
+}
+
+bool AssetStreamer::UploadStrip(Entry &entry)
+{
+    const Image &image = entry.image;
+    if (entry.texture.id == 0)
+    {
+        entry.texture.id = rlLoadTexture(nullptr, image.width, image.height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+        entry.texture.width = image.width;
+        entry.texture.height = image.height;
+        entry.texture.mipmaps = 1;
+        entry.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        if (entry.texture.id == 0)
+        {
+            return false;
+        }
+        SetTextureFilter(entry.texture, TEXTURE_FILTER_BILINEAR);
+    }
+    const int rows = std::min(kUploadStripRows, image.height - entry.rowsUploaded);
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4u;
+    const unsigned char *pixels = static_cast<const unsigned char *>(image.data) + rowBytes * static_cast<size_t>(entry.rowsUploaded);
+    UpdateTextureRec(
+        entry.texture,
+        Rectangle{0.0f, static_cast<float>(entry.rowsUploaded), static_cast<float>(image.width), static_cast<float>(rows)},
+        pixels);
+    entry.rowsUploaded += rows;
+    return true;
+}
+
+void AssetStreamer::Pump(double budgetMs)
+{
+    ++frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &done : decoded)
+        {
+            const auto it = entries.find(done.path);
+            if (it == entries.end())
+            {
+                UnloadImage(done.image);
+                continue;
+            }
+            if (done.image.data == nullptr || done.image.width <= 0 || done.image.height <= 0)
+            {
+                TraceLog(LOG_WARNING, "STREAM: cannot decode %s", done.path.c_str());
+                it->second.state = State::Failed;
+                --pending;
+                continue;
+            }
+            it->second.image = done.image;
+            it->second.state = State::Uploading;
+            uploads.push_back(done.path);
+        }
+        decoded.clear();
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto spent = [&]()
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    };
+    while (!uploads.empty() && spent() < budgetMs)
+    {
+        Entry &entry = entries[uploads.front()];
+        if (!UploadStrip(entry))
+        {
+            TraceLog(LOG_WARNING, "STREAM: cannot allocate texture for %s", uploads.front().c_str());
+            UnloadImage(entry.image);
+            entry.image = Image{};
+            entry.state = State::Failed;
+            --pending;
+            uploads.pop_front();
+            continue;
+        }
+        if (entry.rowsUploaded < entry.image.height)
+        {
+            continue;
+        }
+        entry.bytes = static_cast<size_t>(entry.image.width) * static_cast<size_t>(entry.image.height) * 4u;
+        UnloadImage(entry.image);
+        entry.image = Image{};
+        entry.state = State::Resident;
+        lru.push_front(uploads.front());
+        entry.lru = lru.begin();
+        residentBytes += entry.bytes;
+        --pending;
+        uploads.pop_front();
+    }
+    Evict();
+}
+
+const Texture2D *AssetStreamer::Find(const std::string &path)
+{
+    const auto it = entries.find(path);
+    if (it == entries.end() || it->second.state != State::Resident)
+    {
+        return nullptr;
+    }
+    Entry &entry = it->second;
+    entry.lastUsed = frame;
+    lru.splice(lru.begin(), lru, entry.lru);
+    return &entry.texture;
+}
+
+void AssetStreamer::Evict()
+{
+    while (residentBytes > budget && !lru.empty())
+    {
+        const auto it = entries.find(lru.back());
+        if (it->second.lastUsed + 1 >= frame)
+        {
+            break; // everything left is in use
+        }
+        UnloadTexture(it->second.texture);
+        residentBytes -= it->second.bytes;
+        lru.pop_back();
+        entries.erase(it); // a later Request streams it again
+    }
+}
+
+void AssetStreamer::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.clear();
+    }
+    for (auto &item : entries)
+    {
+        if (item.second.texture.id != 0)
+        {
+            UnloadTexture(item.second.texture);
+        }
+        if (item.second.image.data != nullptr)
+        {
+            UnloadImage(item.second.image);
+        }
+    }
+    entries.clear();
+    lru.clear();
+    uploads.clear();
+    residentBytes = 0;
+    pending = 0;
+}
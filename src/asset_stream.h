@@ -0,0 +1,94 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Streams image files into textures without stalling the frame. A worker
+// thread decodes requested files to RGBA8; Pump, on the main thread, uploads
+// decoded images a strip of rows at a time until its per-frame budget is
+// spent. Resident textures form an LRU cache capped at `budgetBytes`; a
+// texture drawn this frame is never evicted.
+class AssetStreamer
+{
+public:
+    explicit AssetStreamer(size_t budgetBytes = size_t{256} << 20);
+    AssetStreamer(const AssetStreamer &) = delete;
+    AssetStreamer &operator=(const AssetStreamer &) = delete;
+    ~AssetStreamer();
+
+    void SetRoot(const std::string &directory) { root = directory; }
+
+    // Idempotent. Urgent requests jump the decode queue.
+    void Request(const std::string &path, bool urgent);
+
+    // Uploads for at most budgetMs, then trims the cache to its cap.
+    void Pump(double budgetMs);
+
+    // Resident texture for path, or nullptr while it is still streaming.
+    const Texture2D *Find(const std::string &path);
+
+    // Unloads every texture; call before the GL context goes away.
+    void Shutdown();
+
+    size_t ResidentBytes() const { return residentBytes; }
+    size_t PendingCount() const { return pending; }
+
+private:
+    enum class State
+    {
+        Queued,
+        Uploading,
+        Resident,
+        Failed
+    };
+
+    struct Entry
+    {
+        State state = State::Queued;
+        Texture2D texture{};
+        Image image{};
+        int rowsUploaded = 0;
+        size_t bytes = 0;
+        uint64_t lastUsed = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    struct Decoded
+    {
+        std::string path;
+        Image image{};
+    };
+
+    void Worker();
+    bool UploadStrip(Entry &entry);
+    void Evict();
+
+    std::string root;
+    size_t budget = 0;
+    size_t residentBytes = 0;
+    size_t pending = 0;
+    uint64_t frame = 0;
+
+    // Main thread only.
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // front is most recently used
+    std::deque<std::string> uploads;
+
+    // Shared with the worker.
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::string> requests;
+    std::vector<Decoded> decoded;
+    bool stopping = false;
+    std::thread worker;
+};
@@ -0,0 +1,2000 @@
+#include "bench.h"
+
+#include "raylib.h"
+
+#include "alloc_counter.h"
+#include "conditions.h"
+#include "dialogue_panel.h"
+#include "jobs.h"
+#include "navmesh.h"
+#include "particles.h"
+#include "replay.h"
+#include "sim.h"
+#include "sim_clock.h"
+#include "sim_thread.h"
+#include "text_layout.h"
+#include "xorshift.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+static double MsSince(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static std::string TempPath(const std::string &name)
+{
+    std::error_code ec;
+    return (std::filesystem::temp_directory_path(ec) / name).string();
+}
+
+static bool InitWorld(const ContentPack &content, SimWorld &world)
+{
+    std::string error;
+    if (!InitSim(content, world, error))
+    {
+        std::fprintf(stderr, "CONTENT: %s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool LoadReplayFile(const std::string &path, Replay &replay)
+{
+    std::string error;
+    if (!LoadReplay(path, replay, error))
+    {
+        std::fprintf(stderr, "REPLAY: %s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Last line of every test and check, and its exit code.
+static int Verdict(const char *tag, bool passed)
+{
+    std::fprintf(stderr, "%s: %s\n", tag, passed ? "all checks passed" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+static const SimInput *ReplayInput(const Replay &replay, size_t &cursor, uint32_t frame)
+{
+    while (cursor < replay.events.size() && replay.events[cursor].frame < frame)
+    {
+        ++cursor;
+    }
+    if (cursor < replay.events.size() && replay.events[cursor].frame == frame)
+    {
+        return &replay.events[cursor].input;
+    }
+    return nullptr;
+}
+
+// A save file no other run uses, for worlds that must not touch the
+// player's save.
+static std::filesystem::path ScratchSavePath()
+{
+    static uint32_t runCounter = 0;
+    return TempPath("worldforge_replay_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" +
+                    std::to_string(++runCounter) + ".wfs");
+}
+
+// Points the world's saves at savePath with no legacy fallback.
+static void UseScratchSave(SimWorld &world, const std::filesystem::path &savePath)
+{
+    world.savePath = savePath.string();
+    world.legacySavePath.clear();
+}
+
+// Plays a replay from a fresh world and calls onFrame(frame, hash) after
+// every step. Saves go to a temp file owned by this run (and there is no
+// legacy fallback), so a replay never reads or clobbers the player's save
+// and every run starts from the same disk state.
+template <typename OnFrame>
+static bool PlayReplay(const ContentPack &content, const Replay &replay, OnFrame &&onFrame, std::string &error)
+{
+    std::error_code ec;
+    const std::filesystem::path savePath = ScratchSavePath();
+    bool completed = false;
+    {
+        SimWorld world;
+        if (!InitSim(content, world, error))
+        {
+            return false;
+        }
+        UseScratchSave(world, savePath);
+
+        const SimInput idle{};
+        size_t cursor = 0;
+        uint32_t frame = 0;
+        for (; frame < replay.frameCount; ++frame)
+        {
+            const SimInput *input = ReplayInput(replay, cursor, frame);
+            if (!StepSim(world, input != nullptr ? *input : idle, replay.dt))
+            {
+                break;
+            }
+            onFrame(frame, HashSimState(world));
+        }
+        completed = frame == replay.frameCount;
+        if (!completed)
+        {
+            error = "sim stopped at frame " + std::to_string(frame);
+        }
+    }
+    std::filesystem::remove(savePath, ec);
+    return completed;
+}
+
+int RunHeadless(const ContentPack &content, const std::string &replayPath)
+{
+    Replay replay;
+    if (!LoadReplayFile(replayPath, replay))
+    {
+        return 1;
+    }
+    std::string error;
+
+    uint32_t frames = 0;
+    const auto started = std::chrono::steady_clock::now();
+    const bool completed = PlayReplay(content, replay, [&](uint32_t frame, uint64_t hash)
+                                      {
+                                          std::printf("%u %016llx\n", frame, static_cast<unsigned long long>(hash));
+                                          frames = frame + 1u;
+                                      },
+                                      error);
+    const double seconds = MsSince(started) * 1e-3;
+    std::fprintf(stderr, "headless: %u frames in %.3f s (%.0f frames/s)\n",
+                 frames, seconds, seconds > 0.0 ? frames / seconds : 0.0);
+    if (!completed)
+    {
+        std::fprintf(stderr, "headless: %s\n", error.c_str());
+    }
+    return completed ? 0 : 1;
+}
+
+// Plays the replay twice in fresh worlds and fails at the first frame whose
+// hash differs. Catches state that leaks between runs (disk, statics,
+// uninitialised fields) without needing a second build.
+static int RunReplayCheck(const ContentPack &content, const std::string &replayPath)
+{
+    Replay replay;
+    if (!LoadReplayFile(replayPath, replay))
+    {
+        return 1;
+    }
+    std::string error;
+
+    std::vector<uint64_t> first;
+    first.reserve(replay.frameCount);
+    if (!PlayReplay(content, replay, [&](uint32_t, uint64_t hash) { first.push_back(hash); }, error))
+    {
+        std::fprintf(stderr, "check-replay: first run: %s\n", error.c_str());
+        return 1;
+    }
+    size_t divergence = first.size();
+    size_t frames = 0;
+    if (!PlayReplay(content, replay, [&](uint32_t frame, uint64_t hash)
+                    {
+                        if (divergence == first.size() && hash != first[frame])
+                        {
+                            divergence = frame;
+                        }
+                        ++frames;
+                    },
+                    error))
+    {
+        std::fprintf(stderr, "check-replay: second run: %s\n", error.c_str());
+        return 1;
+    }
+    if (divergence != first.size())
+    {
+        std::fprintf(stderr, "check-replay: FAIL, runs diverge at frame %zu\n", divergence);
+        return 1;
+    }
+    std::fprintf(stderr, "check-replay: %zu frames, both runs identical (final %016llx)\n",
+                 frames, static_cast<unsigned long long>(first.empty() ? 0u : first.back()));
+    return 0;
+}
+
+// Checks the fixed-step clock two ways. First SimClock itself: random frame
+// times and stalls must hand out every tick the clamped time pays for, and
+// no more than the clamp allows. Then the window path: the replay's inputs
+// arrive on jittered render frames, are merged into the next tick the way
+// SimThread does, and every tick goes through ReplayRecorder. Loading that
+// recording and playing it headless must reproduce the live hashes tick for
+// tick, so a session recorded at any frame rate replays identically.
+static int RunClockCheck(const ContentPack &content, const std::string &replayPath)
+{
+    XorShift32 rng;
+    const auto frameSeconds = [&]()
+    {
+        // 4-40 ms frames with an occasional long stall.
+        return rng.Next() % 97u == 0u ? 0.6f : static_cast<float>(4u + rng.Next() % 37u) / 1000.0f;
+    };
+
+    size_t clockErrors = 0;
+    {
+        SimClock clock;
+        double paid = 0.0;
+        uint64_t ticks = 0;
+        const uint32_t maxTicks = static_cast<uint32_t>(std::ceil(SimClock::kMaxFrameSeconds / clock.Tick())) + 1u;
+        for (int frame = 0; frame < 200000; ++frame)
+        {
+            const float seconds = frameSeconds();
+            const uint32_t n = clock.Advance(seconds);
+            paid += std::min(seconds, SimClock::kMaxFrameSeconds);
+            ticks += n;
+            clockErrors += n > maxTicks || clock.Alpha() < 0.0f || clock.Alpha() >= 1.0f;
+        }
+        // Float accumulation may drift by a fraction of a tick, never more.
+        const double expected = paid / clock.Tick();
+        clockErrors += std::fabs(static_cast<double>(ticks) - expected) > 1.0;
+        std::fprintf(stderr, "check-clock: %llu ticks for %.1f s of clamped frame time (expected %.1f)\n",
+                     static_cast<unsigned long long>(ticks), paid, expected);
+    }
+
+    Replay source;
+    if (!LoadReplayFile(replayPath, source))
+    {
+        return 1;
+    }
+    std::string error;
+    std::error_code ec;
+    const std::string recordPath = ScratchSavePath().replace_extension(".wfr").string();
+    ReplayRecorder recorder;
+    if (!recorder.Open(recordPath, kSimTickSeconds))
+    {
+        std::fprintf(stderr, "check-clock: cannot record to %s\n", recordPath.c_str());
+        return 1;
+    }
+    std::vector<uint64_t> live;
+    size_t delivered = 0;
+    size_t inputTicks = 0;
+    {
+        const std::filesystem::path savePath = ScratchSavePath();
+        {
+            SimWorld world;
+            if (!InitWorld(content, world))
+            {
+                return 1;
+            }
+            UseScratchSave(world, savePath);
+
+            SimClock clock;
+            SimInput pending;
+            size_t cursor = 0;
+            double now = 0.0;
+            const double end = static_cast<double>(source.frameCount) * source.dt;
+            while (now < end)
+            {
+                const float seconds = frameSeconds();
+                now += std::min(seconds, SimClock::kMaxFrameSeconds);
+                for (; cursor < source.events.size() && source.events[cursor].frame * static_cast<double>(source.dt) <= now; ++cursor)
+                {
+                    MergeInput(pending, source.events[cursor].input);
+                    ++delivered;
+                }
+                for (uint32_t t = clock.Advance(seconds); t > 0; --t)
+                {
+                    inputTicks += pending.click || pending.choice >= 0 || pending.save || pending.load || pending.rewind;
+                    recorder.Record(static_cast<uint32_t>(live.size()), pending);
+                    if (!StepSim(world, pending, clock.Tick()))
+                    {
+                        std::fprintf(stderr, "check-clock: live sim stopped at tick %zu\n", live.size());
+                        recorder.Close(static_cast<uint32_t>(live.size()));
+                        std::filesystem::remove(recordPath, ec);
+                        return 1;
+                    }
+                    pending = SimInput{};
+                    live.push_back(HashSimState(world));
+                }
+            }
+        }
+        std::filesystem::remove(savePath, ec);
+    }
+    recorder.Close(static_cast<uint32_t>(live.size()));
+    Replay recorded;
+    const bool loaded = LoadReplay(recordPath, recorded, error);
+    std::filesystem::remove(recordPath, ec);
+    if (!loaded)
+    {
+        std::fprintf(stderr, "check-clock: recording: %s\n", error.c_str());
+        return 1;
+    }
+
+    size_t divergence = live.size();
+    if (!PlayReplay(content, recorded, [&](uint32_t frame, uint64_t hash)
+                    {
+                        if (divergence == live.size() && hash != live[frame])
+                        {
+                            divergence = frame;
+                        }
+                    },
+                    error))
+    {
+        std::fprintf(stderr, "check-clock: replay of the recording: %s\n", error.c_str());
+        return 1;
+    }
+    std::fprintf(stderr, "check-clock: %zu ticks live, %zu inputs delivered on %zu ticks, replay %s\n",
+                 live.size(), delivered, inputTicks,
+                 divergence == live.size() ? "identical" : ("diverges at tick " + std::to_string(divergence)).c_str());
+    const bool passed = clockErrors == 0 && divergence == live.size() && delivered == source.events.size();
+    return Verdict("check-clock", passed);
+}
+
+// Runs a real SimThread in wall-clock time, submitting the replay's inputs
+// when they fall due, while this thread acquires snapshots the way the
+// window does and checks each one is whole. The thread's own recording is
+// then played headless and must end on the same hash as the threaded world.
+// Covers events up to one second past the replay's last input.
+static int RunSimThreadCheck(const ContentPack &content, const std::string &replayPath)
+{
+    Replay source;
+    if (!LoadReplayFile(replayPath, source))
+    {
+        return 1;
+    }
+    std::string error;
+    std::error_code ec;
+    const std::filesystem::path savePath = ScratchSavePath();
+    const std::string recordPath = ScratchSavePath().replace_extension(".wfr").string();
+    ReplayRecorder recorder;
+    if (!recorder.Open(recordPath, kSimTickSeconds))
+    {
+        std::fprintf(stderr, "check-sim-thread: cannot record to %s\n", recordPath.c_str());
+        return 1;
+    }
+
+    uint64_t threadedHash = 0;
+    uint32_t frames = 0;
+    size_t snapshots = 0;
+    size_t broken = 0;
+    {
+        SimWorld world;
+        if (!InitWorld(content, world))
+        {
+            return 1;
+        }
+        UseScratchSave(world, savePath);
+
+        SimThread sim;
+        sim.Start(world, &recorder, "null_bell_protocol");
+        const double lastInput = source.events.empty() ? 0.0 : source.events.back().frame * static_cast<double>(source.dt);
+        const auto started = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lastTaken{};
+        size_t cursor = 0;
+        for (;;)
+        {
+            const double now = MsSince(started) * 1e-3;
+            if (now > lastInput + 1.0 || sim.Finished())
+            {
+                break;
+            }
+            for (; cursor < source.events.size() && source.events[cursor].frame * static_cast<double>(source.dt) <= now; ++cursor)
+            {
+                sim.Submit(source.events[cursor].input);
+            }
+
+            const FrameSnapshot &frame = sim.Acquire();
+            ++snapshots;
+            bool whole = frame.taken >= lastTaken && frame.alpha >= 0.0f && frame.alpha <= 1.0f &&
+                         frame.current.scene != nullptr && frame.previous.scene != nullptr &&
+                         frame.chronicleCount <= kChronicleHistory;
+            for (size_t i = 0; whole && i < frame.chronicleCount; ++i)
+            {
+                whole = frame.chronicle[i].length < sizeof(frame.chronicle[i].text) &&
+                        frame.chronicle[i].text[frame.chronicle[i].length] == '\0';
+            }
+            if (whole && frame.state == GameState::Dialogue)
+            {
+                const PackNode *node = content.Node(frame.activeDialogueNode);
+                whole = node != nullptr && frame.choiceUnlocked.size() == content.Choices(*node).size();
+            }
+            broken += !whole;
+            lastTaken = frame.taken;
+            std::this_thread::sleep_for(std::chrono::milliseconds(4));
+        }
+        sim.Stop();
+        frames = sim.Frames();
+        recorder.Close(frames);
+        threadedHash = HashSimState(world);
+    }
+    std::filesystem::remove(savePath, ec);
+
+    Replay recorded;
+    const bool loaded = LoadReplay(recordPath, recorded, error);
+    std::filesystem::remove(recordPath, ec);
+    uint64_t replayedHash = 0;
+    uint32_t replayedFrames = 0;
+    if (!loaded || !PlayReplay(content, recorded, [&](uint32_t frame, uint64_t hash)
+                               {
+                                   replayedHash = hash;
+                                   replayedFrames = frame + 1u;
+                               },
+                               error))
+    {
+        std::fprintf(stderr, "check-sim-thread: replay of the recording: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr, "check-sim-thread: %u ticks, %zu snapshots (%zu torn), threaded %016llx, replayed %016llx over %u ticks\n",
+                 frames, snapshots, broken, static_cast<unsigned long long>(threadedHash),
+                 static_cast<unsigned long long>(replayedHash), replayedFrames);
+    const bool passed = broken == 0 && frames > 0 && replayedFrames == frames && replayedHash == threadedHash;
+    return Verdict("check-sim-thread", passed);
+}
+
+// Times the particle integrate/respawn step alone, without a window.
+static int RunParticleBench(int count)
+{
+    ParticleEmitter emitter;
+    emitter.budget = static_cast<uint32_t>(count);
+    emitter.color = WHITE;
+    emitter.drift = Vector2{4.0f, -6.0f};
+    emitter.jitter = Vector2{6.0f, 4.0f};
+    emitter.lifeMin = 1.0f;
+    emitter.lifeMax = 3.0f;
+
+    ParticleField field;
+    field.Reset(std::vector<ParticleEmitter>{emitter}, Vector2{3200.0f, 2000.0f});
+    const int steps = 600;
+    const auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i)
+    {
+        field.Update(1.0f / 60.0f);
+    }
+    const double seconds = MsSince(started) * 1e-3;
+    std::fprintf(stderr, "particles: %zu x %d steps in %.3f s (%.2f ms/step, %.2f ns/particle)\n",
+                 field.Count(), steps, seconds, seconds * 1000.0 / steps,
+                 seconds * 1e9 / (static_cast<double>(steps) * static_cast<double>(std::max<size_t>(field.Count(), 1))));
+    return 0;
+}
+
+// Times path queries between random start/goal pairs in every scene of the
+// pack. Points are drawn over the walk bounds, so some land in holes or off
+// the floor and take the clamping path the way real clicks do.
+static int RunNavBench(const ContentPack &content, int queries)
+{
+    SimWorld world;
+    if (!InitWorld(content, world))
+    {
+        return 1;
+    }
+    std::vector<const Scene *> scenes;
+    for (const auto &entry : world.scenes)
+    {
+        scenes.push_back(&entry.second);
+    }
+    std::sort(scenes.begin(), scenes.end(), [](const Scene *a, const Scene *b)
+              { return a->id < b->id; });
+
+    XorShift32 rng;
+    NavQuery query;
+    std::vector<Vector2> path;
+    std::string error;
+    std::vector<double> micros(static_cast<size_t>(queries));
+    for (const Scene *scene : scenes)
+    {
+        NavMesh mesh;
+        const auto buildStart = std::chrono::steady_clock::now();
+        if (!BuildNavMesh(scene->walkPolygon, scene->walkHoles, mesh, error))
+        {
+            std::fprintf(stderr, "nav: %s: %s\n", scene->id.c_str(), error.c_str());
+            return 1;
+        }
+        const double buildMs = MsSince(buildStart);
+
+        const Rectangle bounds = mesh.area.bounds;
+        size_t found = 0;
+        size_t waypoints = 0;
+        for (double &sample : micros)
+        {
+            const Vector2 start{bounds.x + rng.Unit() * bounds.width, bounds.y + rng.Unit() * bounds.height};
+            const Vector2 goal{bounds.x + rng.Unit() * bounds.width, bounds.y + rng.Unit() * bounds.height};
+            const auto started = std::chrono::steady_clock::now();
+            found += FindNavPath(mesh, query, start, goal, path);
+            sample = MsSince(started) * 1e3;
+            waypoints += path.size();
+        }
+        double total = 0.0;
+        for (const double sample : micros)
+        {
+            total += sample;
+        }
+        std::sort(micros.begin(), micros.end());
+        std::fprintf(stderr, "nav: %-16s %4zu tris  build %6.3f ms  query mean %6.2f us  p50 %6.2f us  p99 %6.2f us  (%zu/%d found, %.1f waypoints)\n",
+                     scene->id.c_str(), mesh.triangles.size(), buildMs, total / queries,
+                     micros[micros.size() / 2], micros[micros.size() * 99 / 100], found, queries,
+                     static_cast<double>(waypoints) / queries);
+    }
+    return 0;
+}
+
+// Steps the sim through FreeRoam (walking, then idle) and an open dialogue
+// and fails if any steady-state step touches the heap. Each phase warms up
+// first so arenas, path buffers and queues reach their working size.
+static int RunAllocCheck(const ContentPack &content)
+{
+    SimWorld world;
+    if (!InitWorld(content, world))
+    {
+        return 1;
+    }
+    const float dt = kSimTickSeconds;
+    const int steps = 1200; // ten seconds, so ambient beats land inside
+    const SimInput idle{};
+    const auto run = [&](const SimInput &first, int count)
+    {
+        const uint64_t before = HeapAllocations();
+        StepSim(world, first, dt);
+        for (int i = 1; i < count; ++i)
+        {
+            StepSim(world, idle, dt);
+        }
+        return HeapAllocations() - before;
+    };
+    const auto clickAt = [](Vector2 point)
+    {
+        SimInput input;
+        input.click = true;
+        input.clickWorld = point;
+        return input;
+    };
+
+    // Open floor of the opening scene, clear of every hotspot, with the
+    // hole in between so the path has to bend.
+    const Vector2 across{400.0f, 420.0f};
+    const Vector2 back{1000.0f, 620.0f};
+    run(clickAt(across), steps);
+    run(clickAt(back), steps);
+    const uint64_t freeRoam = run(clickAt(across), steps);
+    const bool roamed = world.state == GameState::FreeRoam;
+
+    const Scene &scene = CurrentScene(world);
+    const auto talk = std::find_if(scene.hotspots.begin(), scene.hotspots.end(), [](const Hotspot &h)
+                                   { return h.dialogueNode >= 0; });
+    if (talk == scene.hotspots.end())
+    {
+        std::fprintf(stderr, "allocs: no dialogue hotspot in %s\n", scene.id.c_str());
+        return 1;
+    }
+    StepSim(world, clickAt(Vector2{talk->area.x + talk->area.width * 0.5f, talk->area.y + talk->area.height * 0.5f}), dt);
+    for (int i = 0; i < 4000 && world.state != GameState::Dialogue; ++i)
+    {
+        StepSim(world, idle, dt);
+    }
+    run(idle, steps);
+    const uint64_t dialogue = run(idle, steps);
+    const bool talked = world.state == GameState::Dialogue;
+
+    // The render side of the open dialogue: the window loop's panel through a
+    // TextLayoutCache in a hidden window. The first frame fills the cache.
+    std::vector<uint8_t> choiceUnlocked;
+    if (const PackNode *node = content.Node(world.activeDialogueNode))
+    {
+        for (const PackChoice &choice : content.Choices(*node))
+        {
+            choiceUnlocked.push_back(ChoiceUnlocked(world, choice) ? 1u : 0u);
+        }
+    }
+    const int panelFrames = 120;
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(1366, 768, "worldforge alloc check");
+    TextLayoutCache textCache;
+    uint64_t panel = 0;
+    for (int f = 0; f < panelFrames; ++f)
+    {
+        const uint64_t before = HeapAllocations();
+        BeginDrawing();
+        ClearBackground(BLACK);
+        DrawDialoguePanel(content, world.activeDialogueNode, choiceUnlocked, textCache, 1366, 768);
+        EndDrawing();
+        textCache.EndFrame();
+        panel += f > 0 ? HeapAllocations() - before : 0;
+    }
+    const bool drewText = textCache.LastFrame().quads > 0;
+    CloseWindow();
+
+    std::fprintf(stderr, "allocs: free roam %llu over %d steps%s, dialogue %llu over %d steps%s, dialogue panel %llu over %d frames%s\n",
+                 static_cast<unsigned long long>(freeRoam), steps, roamed ? "" : " (left free roam)",
+                 static_cast<unsigned long long>(dialogue), steps, talked ? "" : " (dialogue never opened)",
+                 static_cast<unsigned long long>(panel), panelFrames - 1, drewText ? "" : " (no text drawn)");
+    return freeRoam == 0 && dialogue == 0 && panel == 0 && roamed && talked && drewText ? 0 : 1;
+}
+
+// Lays out and draws every dialogue node in the pack (speaker, wrapped line,
+// choice labels) plus a block of chronicle-style lines through one
+// TextLayoutCache in a hidden window, and reports quads, layouts built and
+// render-thread heap allocations per frame. The first frame fills the
+// cache; every later frame must build nothing and allocate nothing. Also
+// times a cached lookup keyed by pack offset against one keyed by text.
+static int RunTextBench(const ContentPack &content, int frames)
+{
+    const PackSpan<PackNode> nodes = content.Nodes();
+    if (nodes.empty())
+    {
+        std::fprintf(stderr, "text: pack has no dialogue nodes\n");
+        return 1;
+    }
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(1366, 768, "worldforge text bench");
+
+    char chronicle[12][96];
+    for (int i = 0; i < 12; ++i)
+    {
+        std::snprintf(chronicle[i], sizeof(chronicle[i]), "FLAG GAINED // bench_flag_%02d", i);
+    }
+    const Color ink{198, 208, 214, 246};
+    TextLayoutCache cache;
+    uint64_t steadyAllocations = 0;
+    size_t steadyBuilt = 0;
+    double steadyMs = 0.0;
+    for (int f = 0; f < frames; ++f)
+    {
+        const uint64_t before = HeapAllocations();
+        BeginDrawing();
+        ClearBackground(BLACK);
+        const auto started = std::chrono::steady_clock::now();
+        for (const PackNode &node : nodes)
+        {
+            cache.Draw(content, node.speaker, Vector2{16.0f, 14.0f}, 22, ink);
+            cache.Draw(content, node.line, Vector2{16.0f, 46.0f}, 19, ink, 1100.0f);
+            float y = 120.0f;
+            for (const PackChoice &choice : content.Choices(node))
+            {
+                cache.Draw(content, choice.text, Vector2{24.0f, y}, 16, ink);
+                y += 30.0f;
+            }
+        }
+        for (int i = 0; i < 12; ++i)
+        {
+            cache.Draw(std::string_view(chronicle[i]), Vector2{14.0f, 520.0f + static_cast<float>(i) * 18.0f}, 15, ink);
+        }
+        const double ms = MsSince(started);
+        EndDrawing();
+        cache.EndFrame();
+        const uint64_t allocations = HeapAllocations() - before;
+        const TextLayoutCache::Stats &stats = cache.LastFrame();
+        if (f == 0)
+        {
+            std::fprintf(stderr, "text: first frame  %zu quads, %zu layouts built, %llu allocations, %.3f ms\n",
+                         stats.quads, stats.layoutsBuilt, static_cast<unsigned long long>(allocations), ms);
+            continue;
+        }
+        steadyAllocations += allocations;
+        steadyBuilt += stats.layoutsBuilt;
+        steadyMs += ms;
+    }
+    const int steadyFrames = std::max(frames - 1, 1);
+    std::fprintf(stderr, "text: steady state %zu quads/frame, %.2f layouts built/frame, %.2f allocations/frame, %.3f ms/frame (%d frames)\n",
+                 cache.LastFrame().quads, static_cast<double>(steadyBuilt) / steadyFrames,
+                 static_cast<double>(steadyAllocations) / steadyFrames, steadyMs / steadyFrames, steadyFrames);
+
+    // Cached lookups of the longest node line, both ways.
+    const PackNode *longest = &nodes[0];
+    for (const PackNode &node : nodes)
+    {
+        longest = node.line.length > longest->line.length ? &node : longest;
+    }
+    const std::string_view longText = content.Str(longest->line);
+    const int lookups = 200000;
+    volatile int sink = cache.Layout(longText, 19, 1100.0f).lines;
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        sink = cache.Layout(content, longest->line, 19, 1100.0f).lines;
+    }
+    const double packNs = MsSince(started) * 1e6 / lookups;
+    started = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        sink = cache.Layout(longText, 19, 1100.0f).lines;
+    }
+    const double textNs = MsSince(started) * 1e6 / lookups;
+    std::fprintf(stderr, "text: cached lookup of a %zu-byte line: pack key %.1f ns, text key %.1f ns\n",
+                 longText.size(), packNs, textNs);
+    (void)sink;
+    CloseWindow();
+
+    const bool clean = steadyAllocations == 0 && steadyBuilt == 0;
+    std::fprintf(stderr, "text: %s\n", clean ? "steady frames allocate nothing" : "FAIL, steady frames allocate or rebuild");
+    return clean ? 0 : 1;
+}
+
+static uint64_t SerialFib(int n)
+{
+    return n < 2 ? static_cast<uint64_t>(n) : SerialFib(n - 1) + SerialFib(n - 2);
+}
+
+// Fork-join: one branch becomes a job, the caller runs the other and then
+// helps until the job is done.
+static uint64_t ParallelFib(JobSystem &jobs, int n)
+{
+    if (n < 20)
+    {
+        return SerialFib(n);
+    }
+    uint64_t left = 0;
+    JobCounter child;
+    const auto branch = [&]()
+    { left = ParallelFib(jobs, n - 1); };
+    jobs.Spawn(child, branch);
+    const uint64_t right = ParallelFib(jobs, n - 2);
+    jobs.Wait(child);
+    return left + right;
+}
+
+// Times fib, a parallel-for over 1M items and a 256-job fan-out/fan-in on
+// 1, 2, 4 ... up to maxThreads threads (the caller counts as one).
+static int RunJobBench(int maxThreads)
+{
+    struct Spin
+    {
+        uint64_t *out;
+        uint64_t seed;
+        void operator()() const
+        {
+            uint64_t x = seed;
+            for (int k = 0; k < 200000; ++k)
+            {
+                x = x * 6364136223846793005ull + 1442695040888963407ull;
+            }
+            *out = x;
+        }
+    };
+
+    const int rounds = 10;
+    std::vector<float> items(size_t{1} << 20, 1.0f);
+    std::vector<uint64_t> fanOut(256, 0);
+    std::vector<Spin> spins;
+    for (size_t slot = 0; slot < fanOut.size(); ++slot)
+    {
+        spins.push_back(Spin{&fanOut[slot], slot + 1u});
+    }
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    // Every round must match the serial answer, or the timings mean nothing.
+    const uint64_t fibExpected = SerialFib(30);
+    std::vector<uint64_t> fanExpected(fanOut.size(), 0);
+    for (size_t slot = 0; slot < fanExpected.size(); ++slot)
+    {
+        Spin{&fanExpected[slot], slot + 1u}();
+    }
+    const auto advance = [](float v)
+    {
+        for (int k = 0; k < 16; ++k)
+        {
+            v = std::sqrt(v * 1.0001f + static_cast<float>(k));
+        }
+        return v;
+    };
+    float itemExpected = 1.0f;
+
+    double base[3] = {};
+    uint64_t check = 0;
+    int mismatches = 0;
+    for (const int threads : threadCounts)
+    {
+        JobSystem jobs;
+        jobs.Start(static_cast<unsigned>(threads - 1));
+        double ms[3] = {};
+        for (int round = 0; round < rounds; ++round)
+        {
+            auto started = std::chrono::steady_clock::now();
+            const uint64_t fib = ParallelFib(jobs, 30);
+            check += fib;
+            if (fib != fibExpected)
+            {
+                std::fprintf(stderr, "jobs: %d threads fib(30) = %llu, expected %llu\n", threads,
+                             static_cast<unsigned long long>(fib), static_cast<unsigned long long>(fibExpected));
+                ++mismatches;
+            }
+            ms[0] += MsSince(started);
+
+            started = std::chrono::steady_clock::now();
+            jobs.ParallelFor(items.size(), 4096, [&](size_t begin, size_t end)
+                             {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    items[i] = advance(items[i]);
+                } });
+            ms[1] += MsSince(started);
+            itemExpected = advance(itemExpected);
+            const size_t itemsWrong = static_cast<size_t>(std::count_if(items.begin(), items.end(), [&](float v)
+                                                                        { return v != itemExpected; }));
+            if (itemsWrong > 0)
+            {
+                std::fprintf(stderr, "jobs: %d threads parallel-for left %zu of %zu items wrong\n", threads, itemsWrong, items.size());
+                ++mismatches;
+            }
+
+            started = std::chrono::steady_clock::now();
+            JobCounter fan;
+            for (const Spin &spin : spins)
+            {
+                jobs.Spawn(fan, spin);
+            }
+            jobs.Wait(fan);
+            for (size_t slot = 0; slot < fanOut.size(); ++slot)
+            {
+                check += fanOut[slot] & 1u;
+                if (fanOut[slot] != fanExpected[slot])
+                {
+                    std::fprintf(stderr, "jobs: %d threads fan-out job %zu did not run\n", threads, slot);
+                    ++mismatches;
+                }
+                fanOut[slot] = 0;
+            }
+            ms[2] += MsSince(started);
+        }
+        for (double &m : ms)
+        {
+            m /= rounds;
+        }
+        if (threads == 1)
+        {
+            std::copy(std::begin(ms), std::end(ms), std::begin(base));
+        }
+        std::fprintf(stderr, "jobs: %2d threads  fib(30) %7.2f ms (x%.2f)  for 1M %7.2f ms (x%.2f)  fan 256 %7.2f ms (x%.2f)\n",
+                     threads, ms[0], base[0] / ms[0], ms[1], base[1] / ms[1], ms[2], base[2] / ms[2]);
+    }
+    std::fprintf(stderr, "jobs: checksum %llu, %d mismatches\n", static_cast<unsigned long long>(check), mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+struct SyntheticSection
+{
+    PackSectionId id;
+    const void *records;
+    size_t count;
+    size_t recordSize;
+};
+
+// Lays sections out the way worldforge_pack does (each 4-byte aligned, all
+// others empty) and writes the image to path, so checks can open synthetic
+// content through ContentPack exactly like the game opens the real pack.
+static bool WriteSyntheticPack(const std::string &path, std::initializer_list<SyntheticSection> sections, size_t &bytes)
+{
+    PackHeader header{};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.sectionCount = static_cast<uint32_t>(kPackSectionCount);
+    for (PackSection &section : header.sections)
+    {
+        section.offset = sizeof(PackHeader);
+    }
+    std::string image(sizeof(PackHeader), '\0');
+    for (const SyntheticSection &section : sections)
+    {
+        image.resize((image.size() + 3u) & ~size_t{3});
+        header.sections[static_cast<size_t>(section.id)] = PackSection{static_cast<uint32_t>(image.size()), static_cast<uint32_t>(section.count)};
+        image.append(static_cast<const char *>(section.records), section.count * section.recordSize);
+    }
+    header.fileSize = static_cast<uint32_t>(image.size());
+    std::memcpy(&image[0], &header, sizeof(header));
+    bytes = image.size();
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    const bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return std::fclose(file) == 0 && written;
+}
+
+// Walks random paths through a synthetic dialogue graph held two ways: the
+// old unordered_map<int, node> with six owned strings per choice, and the
+// pack layout (dense node index, one choice array, string table) written to
+// a temporary pack and read back through ContentPack like the game does.
+// Both walks draw the same choices, so their checksums must agree.
+static int RunDialogueBench(int nodeCount)
+{
+    struct MapChoice
+    {
+        std::string text;
+        int nextNode = -1;
+        std::string setFlag;
+        std::string requiresFlag;
+        std::string blocksIfFlag;
+        std::string startQuest;
+        int composureDelta = 0;
+        int crewTrustDelta = 0;
+        int threatDelta = 0;
+        std::string consequenceLine;
+    };
+    struct MapNode
+    {
+        std::string speaker;
+        std::string line;
+        std::vector<MapChoice> choices;
+    };
+
+    XorShift32 rng;
+    static const char *const kWords[] = {"sonar", "hull", "ballast", "echo", "bell", "protocol", "crew", "pressure",
+                                         "signal", "archive", "static", "depth", "valve", "captain", "drift", "cobalt"};
+    static const char *const kSpeakers[] = {"Captain Vale", "Sonar Officer", "Chief Engineer", "Archivist", "Unknown Voice"};
+    const auto sentence = [&](uint32_t words)
+    {
+        std::string text;
+        for (uint32_t w = 0; w < words; ++w)
+        {
+            text += w == 0 ? "" : " ";
+            text += kWords[rng.Next() % 16u];
+        }
+        return text;
+    };
+
+    // Authored ids are 1-based like the old inline table; the pack stores
+    // id - 1 as the dense index.
+    std::unordered_map<int, MapNode> dialogue;
+    size_t choiceCount = 0;
+    const uint64_t mapAllocsBefore = HeapAllocations();
+    const auto mapStart = std::chrono::steady_clock::now();
+    for (int id = 1; id <= nodeCount; ++id)
+    {
+        MapNode node;
+        node.speaker = kSpeakers[rng.Next() % 5u];
+        node.line = sentence(10u + rng.Next() % 12u);
+        const uint32_t choices = 2u + rng.Next() % 5u;
+        for (uint32_t c = 0; c < choices; ++c)
+        {
+            MapChoice choice;
+            choice.text = sentence(4u + rng.Next() % 5u);
+            choice.nextNode = rng.Next() % 16u == 0u ? -1 : static_cast<int>(1u + rng.Next() % static_cast<uint32_t>(nodeCount));
+            if (rng.Next() % 4u == 0u)
+            {
+                choice.setFlag = "flag_" + std::to_string(rng.Next() % 512u);
+            }
+            choice.consequenceLine = sentence(5u + rng.Next() % 4u);
+            node.choices.push_back(std::move(choice));
+        }
+        choiceCount += choices;
+        dialogue.emplace(id, std::move(node));
+    }
+    const double mapBuildMs = MsSince(mapStart);
+    const uint64_t mapAllocs = HeapAllocations() - mapAllocsBefore;
+
+    // Payload bytes of the map layout: buckets, one heap node per entry,
+    // choice arrays and every string past the small-string buffer.
+    const size_t inlineCapacity = std::string().capacity();
+    const auto heapOf = [&](const std::string &s)
+    {
+        return s.capacity() > inlineCapacity ? s.capacity() + 1u : size_t{0};
+    };
+    size_t mapBytes = dialogue.bucket_count() * sizeof(void *);
+    for (const auto &entry : dialogue)
+    {
+        const MapNode &node = entry.second;
+        mapBytes += sizeof(entry) + sizeof(void *) + heapOf(node.speaker) + heapOf(node.line) + node.choices.capacity() * sizeof(MapChoice);
+        for (const MapChoice &c : node.choices)
+        {
+            mapBytes += heapOf(c.text) + heapOf(c.setFlag) + heapOf(c.requiresFlag) + heapOf(c.blocksIfFlag) +
+                        heapOf(c.startQuest) + heapOf(c.consequenceLine);
+        }
+    }
+
+    // Same graph in pack records, interned the way worldforge_pack does.
+    std::string blob(1, '\0');
+    std::unordered_map<std::string, PackStr> interned;
+    const auto intern = [&](const std::string &s)
+    {
+        if (s.empty())
+        {
+            return PackStr{0, 0};
+        }
+        const auto it = interned.find(s);
+        if (it != interned.end())
+        {
+            return it->second;
+        }
+        const PackStr ref{static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(s.size())};
+        blob.append(s);
+        blob.push_back('\0');
+        interned.emplace(s, ref);
+        return ref;
+    };
+    std::vector<PackNode> nodes;
+    std::vector<PackChoice> choices;
+    for (int id = 1; id <= nodeCount; ++id)
+    {
+        const MapNode &node = dialogue.at(id);
+        nodes.push_back(PackNode{id, intern(node.speaker), intern(node.line), static_cast<uint32_t>(choices.size()), static_cast<uint32_t>(node.choices.size())});
+        for (const MapChoice &c : node.choices)
+        {
+            PackChoice record{};
+            record.text = intern(c.text);
+            record.nextNode = c.nextNode < 0 ? -1 : c.nextNode - 1;
+            record.setFlag = kPackNone;
+            record.consequenceLine = intern(c.consequenceLine);
+            choices.push_back(record);
+        }
+    }
+    std::error_code ec;
+    const std::string packPath = TempPath("worldforge_dialogue_bench.pack");
+    size_t packBytes = 0;
+    const bool written = WriteSyntheticPack(packPath,
+                                            {{PackSectionId::Strings, blob.data(), blob.size(), 1u},
+                                             {PackSectionId::Nodes, nodes.data(), nodes.size(), sizeof(PackNode)},
+                                             {PackSectionId::Choices, choices.data(), choices.size(), sizeof(PackChoice)}},
+                                            packBytes);
+    ContentPack pack;
+    std::string error;
+    const uint64_t packAllocsBefore = HeapAllocations();
+    const auto openStart = std::chrono::steady_clock::now();
+    const bool opened = written && pack.Open(packPath, error);
+    const double packOpenMs = MsSince(openStart);
+    if (!opened)
+    {
+        std::fprintf(stderr, "dialogue: cannot write or open %s %s\n", packPath.c_str(), error.c_str());
+        std::filesystem::remove(packPath, ec);
+        return 1;
+    }
+
+    const int walks = 4096;
+    const int steps = 256;
+    const uint32_t walkSeed = 0x2545f491u;
+    const uint32_t count = static_cast<uint32_t>(nodeCount);
+
+    rng.state = walkSeed;
+    uint64_t mapSum = 0;
+    const auto mapWalkStart = std::chrono::steady_clock::now();
+    for (int w = 0; w < walks; ++w)
+    {
+        int id = static_cast<int>(1u + rng.Next() % count);
+        for (int s = 0; s < steps; ++s)
+        {
+            const auto it = dialogue.find(id);
+            const MapNode &node = it->second;
+            mapSum += node.speaker.size() + node.line.size() + static_cast<unsigned char>(node.line[0]);
+            const MapChoice &c = node.choices[rng.Next() % node.choices.size()];
+            mapSum += c.text.size() + c.consequenceLine.size() + static_cast<unsigned char>(c.text[0]);
+            id = c.nextNode >= 0 ? c.nextNode : static_cast<int>(1u + rng.Next() % count);
+        }
+    }
+    const double mapWalkMs = MsSince(mapWalkStart);
+
+    rng.state = walkSeed;
+    uint64_t packSum = 0;
+    const auto packWalkStart = std::chrono::steady_clock::now();
+    for (int w = 0; w < walks; ++w)
+    {
+        int index = static_cast<int>(rng.Next() % count);
+        for (int s = 0; s < steps; ++s)
+        {
+            const PackNode &node = *pack.Node(index);
+            const std::string_view line = pack.Str(node.line);
+            packSum += pack.Str(node.speaker).size() + line.size() + static_cast<unsigned char>(line[0]);
+            const PackSpan<PackChoice> options = pack.Choices(node);
+            const PackChoice &c = options[rng.Next() % options.size()];
+            const std::string_view text = pack.Str(c.text);
+            packSum += text.size() + pack.Str(c.consequenceLine).size() + static_cast<unsigned char>(text[0]);
+            index = c.nextNode >= 0 ? c.nextNode : static_cast<int>(rng.Next() % count);
+        }
+    }
+    const double packWalkMs = MsSince(packWalkStart);
+    const uint64_t packAllocs = HeapAllocations() - packAllocsBefore;
+    pack.Close();
+    std::filesystem::remove(packPath, ec);
+
+    const double stepCount = static_cast<double>(walks) * steps;
+    std::fprintf(stderr, "dialogue: %d nodes, %zu choices, %d walks x %d steps\n", nodeCount, choiceCount, walks, steps);
+    std::fprintf(stderr, "dialogue: map   build %8.2f ms  %7llu allocations (build)        %8.2f MiB  walk %6.1f ns/step\n",
+                 mapBuildMs, static_cast<unsigned long long>(mapAllocs), mapBytes / 1048576.0, mapWalkMs * 1e6 / stepCount);
+    std::fprintf(stderr, "dialogue: pack  open  %8.2f ms  %7llu allocations (open + walk)  %8.2f MiB  walk %6.1f ns/step (mapped file)\n",
+                 packOpenMs, static_cast<unsigned long long>(packAllocs), packBytes / 1048576.0, packWalkMs * 1e6 / stepCount);
+    std::fprintf(stderr, "dialogue: checksum %s\n", mapSum == packSum ? "match" : "MISMATCH");
+    return mapSum == packSum ? 0 : 1;
+}
+
+// Picks random points against synthetic hotspots (rectangles, outlines,
+// masks, mixed z) through the grid index and through a scan of every
+// hotspot in pick order, and fails if the two ever disagree.
+static int RunHotspotBench(int count)
+{
+    XorShift32 rng;
+    const Vector2 world{3200.0f, 2000.0f};
+    std::vector<Hotspot> hotspots(static_cast<size_t>(count));
+    for (size_t i = 0; i < hotspots.size(); ++i)
+    {
+        Hotspot &h = hotspots[i];
+        h.area = Rectangle{rng.Unit() * world.x, rng.Unit() * world.y, 40.0f + rng.Unit() * 360.0f, 40.0f + rng.Unit() * 360.0f};
+        h.z = static_cast<int>(rng.Unit() * 4.0f);
+        const Rectangle &r = h.area;
+        if (i % 3u == 1u)
+        {
+            h.outline = {{r.x + r.width * 0.25f, r.y}, {r.x + r.width * 0.75f, r.y}, {r.x + r.width, r.y + r.height * 0.5f},
+                         {r.x + r.width * 0.75f, r.y + r.height}, {r.x + r.width * 0.25f, r.y + r.height}, {r.x, r.y + r.height * 0.5f}};
+        }
+        if (i % 5u == 2u)
+        {
+            h.mask.width = 16;
+            h.mask.height = 16;
+            h.mask.bits.resize(8);
+            for (uint32_t &word : h.mask.bits)
+            {
+                word = rng.Next();
+            }
+        }
+    }
+    HotspotIndex index;
+    const auto buildStart = std::chrono::steady_clock::now();
+    BuildHotspotIndex(hotspots, index);
+    const double buildMs = MsSince(buildStart);
+
+    const int picks = 200000;
+    std::vector<Vector2> points(static_cast<size_t>(picks));
+    for (Vector2 &p : points)
+    {
+        p = Vector2{-100.0f + rng.Unit() * (world.x + 600.0f), -100.0f + rng.Unit() * (world.y + 600.0f)};
+    }
+    std::vector<int> grid(points.size());
+    std::vector<int> scan(points.size());
+    auto started = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        grid[k] = PickHotspot(hotspots, index, points[k]);
+    }
+    const double gridNs = MsSince(started) * 1e6 / picks;
+    started = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        int best = -1;
+        for (size_t i = 0; i < hotspots.size(); ++i)
+        {
+            if ((best < 0 || hotspots[i].z > hotspots[static_cast<size_t>(best)].z) && HotspotContains(hotspots[i], points[k]))
+            {
+                best = static_cast<int>(i);
+            }
+        }
+        scan[k] = best;
+    }
+    const double scanNs = MsSince(started) * 1e6 / picks;
+
+    size_t hits = 0;
+    size_t mismatches = 0;
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        hits += grid[k] >= 0;
+        mismatches += grid[k] != scan[k];
+    }
+    std::fprintf(stderr, "hotspots: %d in %dx%d cells, build %.3f ms, %d picks (%zu hits)\n",
+                 count, index.cols, index.rows, buildMs, picks, hits);
+    std::fprintf(stderr, "hotspots: grid %.1f ns/pick, scan %.1f ns/pick, %zu mismatches\n", gridNs, scanNs, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Round-trips a snapshot through EncodeSave/DecodeSave and a real file,
+// then checks that every truncation and every single-bit flip of the
+// encoded bytes is rejected, and that a legacy text save still decodes.
+static int RunSaveTest()
+{
+    int failures = 0;
+    const auto expect = [&](bool ok, const char *what)
+    {
+        if (!ok)
+        {
+            ++failures;
+            std::fprintf(stderr, "save: FAIL %s\n", what);
+        }
+    };
+
+    const unsigned char history[] = {2, 0, 0, 0, 7, 1, 9, 0, 0, 0, 3};
+    SaveData data;
+    data.sceneId = "control_room";
+    data.playerPos = Vector2{412.5f, 388.0f};
+    data.targetPos = Vector2{900.25f, 610.0f};
+    data.composure = 62;
+    data.crewTrust = -4;
+    data.threat = 17;
+    data.flags = {"sonar_ghost_confirmed", "bell_protocol_known", "archive_unlocked"};
+    data.quests = {SaveQuest{"null_bell_protocol", QuestState::Active, 2}, SaveQuest{"hull_whisper", QuestState::Completed, 0}};
+    data.contentFingerprint = 0x9e3779b97f4a7c15ull;
+    data.history = history;
+    data.historySize = sizeof(history);
+    std::vector<unsigned char> encoded;
+    EncodeSave(data, encoded);
+
+    const auto sameAsData = [&](const SaveData &out)
+    {
+        const auto sameQuest = [](const SaveQuest &a, const SaveQuest &b)
+        {
+            return a.id == b.id && a.state == b.state && a.objectiveIndex == b.objectiveIndex;
+        };
+        return out.sceneId == data.sceneId && out.playerPos.x == data.playerPos.x && out.playerPos.y == data.playerPos.y &&
+               out.targetPos.x == data.targetPos.x && out.targetPos.y == data.targetPos.y && out.composure == data.composure &&
+               out.crewTrust == data.crewTrust && out.threat == data.threat && out.flags == data.flags &&
+               out.quests.size() == data.quests.size() &&
+               std::equal(out.quests.begin(), out.quests.end(), data.quests.begin(), sameQuest) &&
+               out.contentFingerprint == data.contentFingerprint && out.historySize == data.historySize &&
+               out.history != nullptr && std::equal(history, history + sizeof(history), out.history);
+    };
+    std::string error;
+    {
+        const std::pmr::vector<unsigned char> bytes(encoded.begin(), encoded.end());
+        SaveData decoded;
+        expect(DecodeSave(bytes, decoded, error) && sameAsData(decoded), "in-memory round trip");
+    }
+    {
+        std::error_code ec;
+        const std::string path = TempPath("worldforge_save_test.wfs");
+        std::pmr::vector<unsigned char> bytes;
+        SaveData decoded;
+        expect(WriteSaveFile(path, encoded) && ReadSaveFile(path, bytes) && DecodeSave(bytes, decoded, error) && sameAsData(decoded),
+               "file round trip");
+        std::filesystem::remove(path, ec);
+    }
+
+    size_t truncationsAccepted = 0;
+    for (size_t n = 0; n < encoded.size(); ++n)
+    {
+        const std::pmr::vector<unsigned char> cut(encoded.begin(), encoded.begin() + static_cast<std::ptrdiff_t>(n));
+        SaveData out;
+        truncationsAccepted += DecodeSave(cut, out, error);
+    }
+    expect(truncationsAccepted == 0, "truncated save accepted");
+
+    size_t flipsAccepted = 0;
+    std::pmr::vector<unsigned char> flipped(encoded.begin(), encoded.end());
+    for (size_t i = 0; i < flipped.size(); ++i)
+    {
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            flipped[i] ^= static_cast<unsigned char>(1u << bit);
+            SaveData out;
+            flipsAccepted += DecodeSave(flipped, out, error);
+            flipped[i] ^= static_cast<unsigned char>(1u << bit);
+        }
+    }
+    expect(flipsAccepted == 0, "bit-flipped save accepted");
+
+    {
+        const char legacy[] = "scene engine_room\nplayer 10 20.5\nstats 50 40 3\nflag sonar_ghost_confirmed\n"
+                              "quest null_bell_protocol active 1\nmystery 1\n";
+        const std::pmr::vector<unsigned char> bytes(legacy, legacy + sizeof(legacy) - 1u);
+        SaveData out;
+        expect(DecodeSave(bytes, out, error) && out.sceneId == "engine_room" && out.playerPos.y == 20.5f && out.threat == 3 &&
+                   out.flags.size() == 1u && out.quests.size() == 1u && out.quests[0].state == QuestState::Active &&
+                   out.quests[0].objectiveIndex == 1u && out.skippedLines == 1u,
+               "legacy text save");
+        const char noScene[] = "player 1 2\nflag a\n";
+        const std::pmr::vector<unsigned char> sceneless(noScene, noScene + sizeof(noScene) - 1u);
+        expect(!DecodeSave(sceneless, out, error), "text save without a scene accepted");
+    }
+
+    std::fprintf(stderr, "save: %zu-byte snapshot, %zu truncations (%zu accepted), %zu bit flips (%zu accepted)\n",
+                 encoded.size(), encoded.size(), truncationsAccepted, encoded.size() * 8u, flipsAccepted);
+    return Verdict("save", failures == 0);
+}
+
+// Encodes and decodes a snapshot with flagCount flags in the binary format
+// and in the old line-based text format, and writes each once through
+// WriteSaveFile (fsync included).
+static int RunSaveBench(int flagCount)
+{
+    std::vector<std::string> names;
+    names.reserve(static_cast<size_t>(flagCount) + 64u);
+    SaveData data;
+    data.sceneId = "control_room";
+    data.playerPos = Vector2{412.5f, 388.0f};
+    data.targetPos = Vector2{900.25f, 610.0f};
+    data.composure = 62;
+    data.crewTrust = 48;
+    data.threat = 17;
+    char name[64];
+    for (int i = 0; i < flagCount; ++i)
+    {
+        std::snprintf(name, sizeof(name), "bench_flag_%05d_signal", i);
+        names.emplace_back(name);
+        data.flags.push_back(names.back());
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        std::snprintf(name, sizeof(name), "bench_quest_%02d", i);
+        names.emplace_back(name);
+        data.quests.push_back(SaveQuest{names.back(), static_cast<QuestState>(i % 3), static_cast<uint32_t>(i % 4)});
+    }
+
+    const int rounds = 50;
+    const auto microsPerRound = [&](std::chrono::steady_clock::time_point since)
+    {
+        return MsSince(since) * 1e3 / rounds;
+    };
+    const auto writeMs = [](const std::vector<unsigned char> &bytes)
+    {
+        std::error_code ec;
+        const std::string path = TempPath("worldforge_save_bench.wfs");
+        const auto started = std::chrono::steady_clock::now();
+        const bool ok = WriteSaveFile(path, bytes);
+        const double ms = MsSince(started);
+        std::filesystem::remove(path, ec);
+        return ok ? ms : -1.0;
+    };
+
+    std::vector<unsigned char> binary;
+    auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        EncodeSave(data, binary);
+    }
+    const double binaryEncodeUs = microsPerRound(started);
+
+    // The pre-binary writer: one "key values..." line per record.
+    std::vector<unsigned char> text;
+    started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        text.clear();
+        char line[160];
+        const auto put = [&](int n)
+        {
+            text.insert(text.end(), line, line + std::min(n, static_cast<int>(sizeof(line)) - 1));
+        };
+        put(std::snprintf(line, sizeof(line), "scene %s\n", std::string(data.sceneId).c_str()));
+        put(std::snprintf(line, sizeof(line), "player %g %g\n", data.playerPos.x, data.playerPos.y));
+        put(std::snprintf(line, sizeof(line), "target %g %g\n", data.targetPos.x, data.targetPos.y));
+        put(std::snprintf(line, sizeof(line), "stats %d %d %d\n", data.composure, data.crewTrust, data.threat));
+        for (const std::string_view flag : data.flags)
+        {
+            put(std::snprintf(line, sizeof(line), "flag %.*s\n", static_cast<int>(flag.size()), flag.data()));
+        }
+        static const char *const kStates[] = {"locked", "active", "completed"};
+        for (const SaveQuest &quest : data.quests)
+        {
+            put(std::snprintf(line, sizeof(line), "quest %.*s %s %u\n", static_cast<int>(quest.id.size()), quest.id.data(),
+                              kStates[static_cast<int>(quest.state)], quest.objectiveIndex));
+        }
+    }
+    const double textEncodeUs = microsPerRound(started);
+
+    const std::pmr::vector<unsigned char> binaryBytes(binary.begin(), binary.end());
+    const std::pmr::vector<unsigned char> textBytes(text.begin(), text.end());
+    SaveData decoded;
+    std::string error;
+    bool ok = true;
+    started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        ok = DecodeSave(binaryBytes, decoded, error) && decoded.flags.size() == data.flags.size() && ok;
+    }
+    const double binaryDecodeUs = microsPerRound(started);
+    started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        ok = DecodeSave(textBytes, decoded, error) && decoded.flags.size() == data.flags.size() && ok;
+    }
+    const double textDecodeUs = microsPerRound(started);
+
+    std::fprintf(stderr, "save: %d flags, %zu quests, %d rounds\n", flagCount, data.quests.size(), rounds);
+    std::fprintf(stderr, "save: binary %8zu bytes  encode %8.1f us  decode %8.1f us  write+fsync %6.2f ms\n",
+                 binary.size(), binaryEncodeUs, binaryDecodeUs, writeMs(binary));
+    std::fprintf(stderr, "save: text   %8zu bytes  encode %8.1f us  decode %8.1f us  write+fsync %6.2f ms\n",
+                 text.size(), textEncodeUs, textDecodeUs, writeMs(text));
+    if (!ok)
+    {
+        std::fprintf(stderr, "save: FAIL, a decode lost flags (%s)\n", error.c_str());
+    }
+    return ok ? 0 : 1;
+}
+
+// Marks thousands of random narrative states in a SaveHistory and checks
+// that every marker reconstructs exactly, before and after an encode/decode
+// round trip, and that a rewind followed by new choices branches cleanly.
+static int RunHistoryTest(int markerCount)
+{
+    XorShift32 rng{0x2545f491u};
+    const auto mutate = [&](HistoryState &state)
+    {
+        for (uint32_t n = rng.Next() % 6u; n > 0; --n)
+        {
+            const uint32_t bit = rng.Next() % (state.flagWords.size() * 64u);
+            state.flagWords[bit / 64u] ^= 1ull << (bit % 64u);
+        }
+        state.composure += static_cast<int>(rng.Next() % 7u) - 3;
+        state.crewTrust += static_cast<int>(rng.Next() % 5u) - 2;
+        state.threat += static_cast<int>(rng.Next() % 3u) - 1;
+        for (uint32_t n = rng.Next() % 3u; n > 0; --n)
+        {
+            HistoryQuest &quest = state.quests[rng.Next() % state.quests.size()];
+            quest.state = static_cast<QuestState>(rng.Next() % 3u);
+            quest.objectiveIndex = rng.Next() % 5u;
+        }
+    };
+    const auto same = [](const HistoryState &a, const HistoryState &b)
+    {
+        return a.flagWords == b.flagWords && a.composure == b.composure && a.crewTrust == b.crewTrust && a.threat == b.threat &&
+               a.quests.size() == b.quests.size() &&
+               std::equal(a.quests.begin(), a.quests.end(), b.quests.begin(), [](const HistoryQuest &x, const HistoryQuest &y)
+                          { return x.state == y.state && x.objectiveIndex == y.objectiveIndex; });
+    };
+    const char *const scenes[] = {"control_room", "sonar_bay", "reliquary"};
+
+    SaveHistory history;
+    std::vector<HistoryState> truth;
+    HistoryState current;
+    current.flagWords.assign(4, 0u);
+    current.quests.resize(12);
+    current.composure = 60;
+    current.crewTrust = 50;
+    const auto mark = [&](int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const int node = static_cast<int>(truth.size());
+            history.Mark(current, node, scenes[node % 3], Vector2{static_cast<float>(node), 2.0f * node});
+            truth.push_back(current);
+            mutate(current);
+        }
+    };
+    size_t mismatches = 0;
+    const auto verify = [&](const SaveHistory &h)
+    {
+        HistoryState out;
+        if (h.Size() != truth.size())
+        {
+            ++mismatches;
+            return;
+        }
+        for (size_t i = 0; i < truth.size(); ++i)
+        {
+            h.StateAt(i, out);
+            const HistoryMarker &marker = h.Marker(i);
+            mismatches += !same(out, truth[i]) || marker.sceneId != scenes[marker.node % 3] || marker.position.x != static_cast<float>(marker.node);
+        }
+    };
+
+    mark(markerCount);
+    verify(history);
+    const size_t markedBytes = history.Bytes();
+
+    std::vector<unsigned char> encoded;
+    history.Encode(encoded);
+    SaveHistory decoded;
+    const bool decodedOk = decoded.Decode(encoded.data(), encoded.size());
+    verify(decoded);
+
+    // Back to the middle, then a new branch of choices from there.
+    const size_t back = truth.size() / 2u;
+    HistoryState restored;
+    HistoryMarker marker;
+    history.Rewind(back, restored, marker);
+    const bool rewoundOk = same(restored, truth[back]) && marker.node == static_cast<int>(back) && history.Size() == back;
+    current = restored;
+    truth.resize(back);
+    mark(markerCount / 4);
+    verify(history);
+
+    const size_t snapshotBytes = static_cast<size_t>(markerCount) * (current.flagWords.size() * sizeof(uint64_t) + 3u * sizeof(int) + current.quests.size() * sizeof(HistoryQuest));
+    std::fprintf(stderr, "history: %d markers in %zu bytes (full snapshots: %zu), encoded %zu bytes\n",
+                 markerCount, markedBytes, snapshotBytes, encoded.size());
+    std::fprintf(stderr, "history: decode %s, rewind to %zu %s, %zu mismatches across %zu checked states\n",
+                 decodedOk ? "ok" : "FAILED", back, rewoundOk ? "ok" : "FAILED", mismatches,
+                 static_cast<size_t>(markerCount) * 2u + truth.size());
+    const bool passed = decodedOk && rewoundOk && mismatches == 0;
+    return Verdict("history", passed);
+}
+
+// Drives an EventDirector over a synthetic pack (flag and stat conditions,
+// scene-bound and fire-once events, cooldowns, priority ties) and compares
+// every Pick with a scan of all events, modelling cooldowns on the same
+// 1/16 s ticks. Also checks the timer wheel against a sorted reference.
+static int RunDirectorTest(int eventCount)
+{
+    XorShift32 rng;
+
+    // Timer wheel: random delays up to ~17 minutes, so all three levels and
+    // the overflow cascade are used, against exact due ticks.
+    size_t wheelErrors = 0;
+    {
+        TimerWheel wheel;
+        wheel.Reset();
+        std::vector<uint64_t> due;
+        std::vector<uint32_t> expired;
+        uint64_t tick = 0;
+        size_t pending = 0;
+        const auto advance = [&]()
+        {
+            wheel.Advance(TimerWheel::kTickSeconds, expired);
+            ++tick;
+            for (const uint32_t id : expired)
+            {
+                wheelErrors += due[id] != tick;
+                due[id] = 0;
+                --pending;
+            }
+            expired.clear();
+        };
+        for (uint32_t id = 0; id < 20000u; ++id)
+        {
+            const uint32_t ticks = 1u + rng.Next() % 16000u;
+            wheel.Schedule(id, static_cast<float>(ticks) * TimerWheel::kTickSeconds);
+            due.push_back(tick + ticks);
+            ++pending;
+            if (rng.Next() % 4u == 0u)
+            {
+                advance();
+            }
+        }
+        while (pending > 0 && tick < 40000u)
+        {
+            advance();
+        }
+        wheelErrors += pending;
+    }
+
+    // Synthetic events. Cooldowns are whole ticks and jitter is zero, so the
+    // reference can model cooling exactly.
+    const uint32_t flagCount = 256;
+    const char *const sceneNames[] = {"control_room", "sonar_bay"};
+    std::string blob(1, '\0');
+    PackStr scenes[2];
+    for (int s = 0; s < 2; ++s)
+    {
+        scenes[s] = PackStr{static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(std::strlen(sceneNames[s]))};
+        blob.append(sceneNames[s]);
+        blob.push_back('\0');
+    }
+    std::vector<PackCondOp> ops;
+    std::vector<PackEvent> events(static_cast<size_t>(eventCount));
+    const auto push = [&](PackCondOpcode op, uint8_t stat, int32_t arg)
+    {
+        ops.push_back(PackCondOp{static_cast<uint8_t>(op), stat, 0, arg});
+    };
+    for (PackEvent &event : events)
+    {
+        event = PackEvent{};
+        event.condFirst = static_cast<uint32_t>(ops.size());
+        const uint32_t terms = rng.Next() % 3u;
+        for (uint32_t k = 0; k < terms; ++k)
+        {
+            push(PackCondOpcode::Flag, 0, static_cast<int32_t>(rng.Next() % flagCount));
+            if (rng.Next() % 3u == 0u)
+            {
+                push(PackCondOpcode::Not, 0, 0);
+            }
+            if (k > 0)
+            {
+                push(rng.Next() % 2u == 0u ? PackCondOpcode::And : PackCondOpcode::Or, 0, 0);
+            }
+        }
+        if (rng.Next() % 2u == 0u)
+        {
+            const PackCondOpcode compare = static_cast<PackCondOpcode>(static_cast<uint32_t>(PackCondOpcode::Less) + rng.Next() % 6u);
+            push(compare, static_cast<uint8_t>(rng.Next() % 3u), static_cast<int32_t>(rng.Next() % 100u));
+            if (terms > 0)
+            {
+                push(PackCondOpcode::And, 0, 0);
+            }
+        }
+        event.condCount = static_cast<uint32_t>(ops.size()) - event.condFirst;
+        event.grantsFlag = rng.Next() % 2u == 0u ? rng.Next() % flagCount : kPackNone;
+        event.fireOnce = event.grantsFlag != kPackNone && rng.Next() % 2u == 0u ? 1u : 0u;
+        event.priority = static_cast<int32_t>(rng.Next() % 6u);
+        event.cooldown = static_cast<float>(rng.Next() % 48u) * TimerWheel::kTickSeconds;
+        event.jitter = 0.0f;
+        const uint32_t scene = rng.Next() % 3u;
+        event.scene = scene < 2u ? scenes[scene] : PackStr{0, 0};
+    }
+
+    std::error_code ec;
+    const std::string packPath = TempPath("worldforge_director_test.pack");
+    size_t packBytes = 0;
+    ContentPack pack;
+    std::string error;
+    if (!WriteSyntheticPack(packPath,
+                            {{PackSectionId::Strings, blob.data(), blob.size(), 1u},
+                             {PackSectionId::Conditions, ops.data(), ops.size(), sizeof(PackCondOp)},
+                             {PackSectionId::Events, events.data(), events.size(), sizeof(PackEvent)}},
+                            packBytes) ||
+        !pack.Open(packPath, error))
+    {
+        std::fprintf(stderr, "director: cannot write or open %s %s\n", packPath.c_str(), error.c_str());
+        std::filesystem::remove(packPath, ec);
+        return 1;
+    }
+
+    EventDirector director;
+    director.Build(pack, flagCount);
+    FlagSet flags;
+    flags.Reserve(flagCount);
+    int stats[] = {60, 55, 30};
+    std::vector<uint64_t> coolUntil(events.size(), 0u);
+    uint64_t tick = 0;
+    size_t sceneIndex = 0;
+    size_t mismatches = 0;
+    size_t fired = 0;
+    const int steps = 20000;
+    for (int step = 0; step < steps; ++step)
+    {
+        director.Advance(TimerWheel::kTickSeconds);
+        ++tick;
+        if (rng.Next() % 2u == 0u)
+        {
+            const FlagId id = rng.Next() % flagCount;
+            if (flags.Set(id))
+            {
+                director.NotifyFlag(id);
+            }
+        }
+        if (rng.Next() % 3u == 0u)
+        {
+            stats[rng.Next() % 3u] = static_cast<int>(rng.Next() % 101u);
+        }
+        if (rng.Next() % 200u == 0u)
+        {
+            sceneIndex ^= 1u;
+        }
+        if (rng.Next() % 1000u == 0u)
+        {
+            // What a load or rewind does: flags can go away.
+            flags.Clear();
+            director.Invalidate();
+        }
+
+        int want = -1;
+        for (size_t e = 0; e < events.size(); ++e)
+        {
+            const PackEvent &event = events[e];
+            const std::string_view scene = pack.Str(event.scene);
+            const bool eligible = tick >= coolUntil[e] && (scene.empty() || scene == sceneNames[sceneIndex]) &&
+                                  !(event.fireOnce != 0u && flags.Test(event.grantsFlag)) &&
+                                  EvaluateCondition(pack.Condition(event), flags, stats);
+            if (eligible && (want < 0 || event.priority > events[static_cast<size_t>(want)].priority))
+            {
+                want = static_cast<int>(e);
+            }
+        }
+        const int got = director.Pick(sceneNames[sceneIndex], flags, stats);
+        mismatches += got != want;
+        if (got < 0)
+        {
+            continue;
+        }
+        ++fired;
+        const PackEvent &event = events[static_cast<size_t>(got)];
+        if (event.grantsFlag != kPackNone && flags.Set(event.grantsFlag))
+        {
+            director.NotifyFlag(event.grantsFlag);
+        }
+        director.Fired(static_cast<uint32_t>(got));
+        if (event.cooldown > 0.0f)
+        {
+            coolUntil[static_cast<size_t>(got)] = tick + static_cast<uint64_t>(std::ceil(event.cooldown / TimerWheel::kTickSeconds));
+        }
+    }
+    pack.Close();
+    std::filesystem::remove(packPath, ec);
+
+    std::fprintf(stderr, "director: timer wheel 20000 timers, %zu errors\n", wheelErrors);
+    std::fprintf(stderr, "director: %d events, %d steps, %zu fired, %zu mismatches against a full scan\n",
+                 eventCount, steps, fired, mismatches);
+    const bool passed = wheelErrors == 0 && mismatches == 0;
+    return Verdict("director", passed);
+}
+
+// Synthetic active quests with four objectives, each done by either of two
+// random flags. Polling every quest per frame (the old loop) is timed
+// against QuestTracker flushes on idle frames and on frames that gain four
+// flags, at three quest counts: the tracker should stay flat as quests grow.
+static int RunQuestBench(int questCount)
+{
+    const int frames = 1000;
+    const int gainsPerFrame = 4;
+    const int counts[] = {std::max(1, questCount / 16), std::max(1, questCount / 4), questCount};
+    for (const int count : counts)
+    {
+        const uint32_t flagCount = static_cast<uint32_t>(count) * 8u;
+        XorShift32 rng;
+
+        std::unordered_map<std::string, Quest> quests;
+        for (int q = 0; q < count; ++q)
+        {
+            Quest quest;
+            quest.id = "quest_" + std::to_string(q);
+            quest.state = QuestState::Active;
+            for (int o = 0; o < 4; ++o)
+            {
+                QuestObjective objective;
+                objective.doneMask.Add(rng.Next() % flagCount);
+                objective.doneMask.Add(rng.Next() % flagCount);
+                quest.objectives.push_back(std::move(objective));
+            }
+            quests.emplace(quest.id, std::move(quest));
+        }
+        std::vector<Quest *> order;
+        for (int q = 0; q < count; ++q)
+        {
+            order.push_back(&quests.at("quest_" + std::to_string(q)));
+        }
+        QuestTracker tracker;
+        tracker.Build(order, flagCount);
+        FlagSet flags;
+        flags.Reserve(flagCount);
+
+        size_t visited = 0;
+        const auto progress = [&](Quest &q)
+        {
+            ++visited;
+            while (q.objectiveIndex < q.objectives.size() && flags.Any(q.objectives[q.objectiveIndex].doneMask))
+            {
+                ++q.objectiveIndex;
+            }
+            if (q.objectiveIndex >= q.objectives.size())
+            {
+                q.state = QuestState::Completed;
+            }
+        };
+        auto started = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+        {
+            for (auto &entry : quests)
+            {
+                progress(entry.second);
+            }
+        }
+        const double pollNs = MsSince(started) * 1e6 / frames;
+
+        started = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+        {
+            tracker.Flush(progress);
+        }
+        const double idleNs = MsSince(started) * 1e6 / frames;
+
+        visited = 0;
+        started = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+        {
+            for (int g = 0; g < gainsPerFrame; ++g)
+            {
+                const FlagId id = rng.Next() % flagCount;
+                if (flags.Set(id))
+                {
+                    tracker.NotifyFlag(id);
+                }
+            }
+            tracker.Flush(progress);
+        }
+        const double changedNs = MsSince(started) * 1e6 / frames;
+
+        size_t completed = 0;
+        for (const auto &entry : quests)
+        {
+            completed += entry.second.state == QuestState::Completed;
+        }
+        std::fprintf(stderr, "quests: %6d quests  poll %9.0f ns/frame  tracker idle %5.1f ns/frame  %d gains %7.0f ns/frame (%.2f quests woken/frame, %zu completed)\n",
+                     count, pollNs, idleNs, gainsPerFrame, changedNs, static_cast<double>(visited) / frames, completed);
+    }
+    return 0;
+}
+
+// Synthetic programs shaped like authored gating: 2-4 flag tests and a stat
+// comparison joined by and/or/not, over 4096 flags with a third of them set.
+static int RunConditionBench(int count)
+{
+    const uint32_t flagCount = 4096;
+    FlagSet flags;
+    flags.Reserve(flagCount);
+    XorShift32 rng;
+    for (uint32_t f = 0; f < flagCount; ++f)
+    {
+        if (rng.Next() % 3u == 0u)
+        {
+            flags.Set(f);
+        }
+    }
+
+    std::vector<PackCondOp> ops;
+    std::vector<std::pair<uint32_t, uint32_t>> programs;
+    const auto push = [&](PackCondOpcode op, uint8_t stat, int32_t arg)
+    {
+        ops.push_back(PackCondOp{static_cast<uint8_t>(op), stat, 0, arg});
+    };
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t first = static_cast<uint32_t>(ops.size());
+        const uint32_t terms = 2u + rng.Next() % 3u;
+        for (uint32_t k = 0; k < terms; ++k)
+        {
+            push(PackCondOpcode::Flag, 0, static_cast<int32_t>(rng.Next() % flagCount));
+            if (rng.Next() % 4u == 0u)
+            {
+                push(PackCondOpcode::Not, 0, 0);
+            }
+            if (k > 0)
+            {
+                push(rng.Next() % 2u == 0u ? PackCondOpcode::And : PackCondOpcode::Or, 0, 0);
+            }
+        }
+        push(PackCondOpcode::GreaterEqual, static_cast<uint8_t>(rng.Next() % 3u), static_cast<int32_t>(rng.Next() % 100u));
+        push(PackCondOpcode::And, 0, 0);
+        programs.emplace_back(first, static_cast<uint32_t>(ops.size()) - first);
+    }
+
+    const int stats[] = {60, 55, 30};
+    const int rounds = 50;
+    size_t passed = 0;
+    const auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (const auto &program : programs)
+        {
+            passed += EvaluateCondition(PackSpan<PackCondOp>{ops.data() + program.first, program.second}, flags, stats);
+        }
+    }
+    const double seconds = MsSince(started) * 1e-3;
+    const double evaluations = static_cast<double>(rounds) * static_cast<double>(programs.size());
+    std::fprintf(stderr, "conditions: %zu programs (%zu ops) x %d rounds in %.3f s (%.2f ms/round, %.1f ns/condition, %zu passed)\n",
+                 programs.size(), ops.size(), rounds, seconds, seconds * 1000.0 / rounds, seconds * 1e9 / evaluations, passed);
+    return 0;
+}
+
+struct BenchFlag
+{
+    const char *name;
+    BenchMode mode;
+    const char *value; // usage placeholder, nullptr for a plain switch
+    int minimum;       // floor of a numeric value; -1 takes a file path
+    bool needsContent;
+    bool usesWorkers;
+};
+
+static const BenchFlag kBenchFlags[] = {
+    {"--bench-particles", BenchMode::Particles, "<count>", 1, false, true},
+    {"--bench-conditions", BenchMode::Conditions, "<count>", 1, false, true},
+    {"--bench-jobs", BenchMode::Jobs, "<threads>", 1, false, false},
+    {"--bench-quests", BenchMode::Quests, "<count>", 1, false, true},
+    {"--bench-dialogue", BenchMode::Dialogue, "<nodes>", 1, false, true},
+    {"--bench-hotspots", BenchMode::Hotspots, "<count>", 1, false, true},
+    {"--bench-save", BenchMode::Save, "<flags>", 1, false, true},
+    {"--test-save", BenchMode::TestSave, nullptr, 0, false, true},
+    {"--test-history", BenchMode::TestHistory, "<markers>", 2, false, true},
+    {"--test-director", BenchMode::TestDirector, "<events>", 1, false, true},
+    {"--bench-nav", BenchMode::Nav, "<queries>", 1, true, true},
+    {"--bench-text", BenchMode::Text, "<frames>", 2, true, true},
+    {"--check-allocs", BenchMode::CheckAllocs, nullptr, 0, true, true},
+    {"--check-replay", BenchMode::CheckReplay, "<file>", -1, true, false},
+    {"--check-clock", BenchMode::CheckClock, "<file>", -1, true, false},
+    {"--check-sim-thread", BenchMode::CheckSimThread, "<file>", -1, true, false},
+};
+
+static const BenchFlag *FindBenchFlag(BenchMode mode)
+{
+    for (const BenchFlag &flag : kBenchFlags)
+    {
+        if (flag.mode == mode)
+        {
+            return &flag;
+        }
+    }
+    return nullptr;
+}
+
+bool ParseBenchArg(int argc, char **argv, int &i, BenchOptions &options)
+{
+    for (const BenchFlag &flag : kBenchFlags)
+    {
+        if (std::strcmp(argv[i], flag.name) != 0)
+        {
+            continue;
+        }
+        if (options.mode != BenchMode::None || (flag.value != nullptr && i + 1 >= argc))
+        {
+            return false;
+        }
+        options.mode = flag.mode;
+        if (flag.value == nullptr)
+        {
+            return true;
+        }
+        ++i;
+        if (flag.minimum < 0)
+        {
+            options.path = argv[i];
+        }
+        else
+        {
+            options.count = std::max(flag.minimum, std::atoi(argv[i]));
+        }
+        return true;
+    }
+    return false;
+}
+
+std::string BenchUsage()
+{
+    std::string usage;
+    for (const BenchFlag &flag : kBenchFlags)
+    {
+        usage += usage.empty() ? "[" : " [";
+        usage += flag.name;
+        if (flag.value != nullptr)
+        {
+            usage += ' ';
+            usage += flag.value;
+        }
+        usage += ']';
+    }
+    return usage;
+}
+
+bool BenchUsesWorkers(const BenchOptions &options)
+{
+    const BenchFlag *flag = FindBenchFlag(options.mode);
+    return flag != nullptr && flag->usesWorkers;
+}
+
+int RunBench(const BenchOptions &options, const std::string &packPath)
+{
+    const BenchFlag *flag = FindBenchFlag(options.mode);
+    if (flag == nullptr)
+    {
+        return 2;
+    }
+    ContentPack content;
+    std::string error;
+    if (flag->needsContent && !content.Open(packPath, error))
+    {
+        TraceLog(LOG_ERROR, "CONTENT: %s (build the worldforge_content target)", error.c_str());
+        return 1;
+    }
+
+    switch (options.mode)
+    {
+    case BenchMode::Particles:
+        return RunParticleBench(options.count);
+    case BenchMode::Conditions:
+        return RunConditionBench(options.count);
+    case BenchMode::Jobs:
+        return RunJobBench(options.count);
+    case BenchMode::Quests:
+        return RunQuestBench(options.count);
+    case BenchMode::Dialogue:
+        return RunDialogueBench(options.count);
+    case BenchMode::Hotspots:
+        return RunHotspotBench(options.count);
+    case BenchMode::Save:
+        return RunSaveBench(options.count);
+    case BenchMode::TestSave:
+        return RunSaveTest();
+    case BenchMode::TestHistory:
+        return RunHistoryTest(options.count);
+    case BenchMode::TestDirector:
+        return RunDirectorTest(options.count);
+    case BenchMode::Nav:
+        return RunNavBench(content, options.count);
+    case BenchMode::Text:
+        return RunTextBench(content, options.count);
+    case BenchMode::CheckAllocs:
+        return RunAllocCheck(content);
+    case BenchMode::CheckReplay:
+        return RunReplayCheck(content, options.path);
+    case BenchMode::CheckClock:
+        return RunClockCheck(content, options.path);
+    case BenchMode::CheckSimThread:
+        return RunSimThreadCheck(content, options.path);
+    case BenchMode::None:
+        break;
+    }
+    return 2;
+}
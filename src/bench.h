@@ -0,0 +1,55 @@
+#pragma once
+
+#include "content_pack.h"
+
+#include <string>
+
+// Modes that run instead of the game window: benches (--bench-*), self-tests
+// (--test-*), checks (--check-*) and headless replay. Each prints to stderr
+// and returns the process exit code.
+
+enum class BenchMode
+{
+    None,
+    Particles,
+    Conditions,
+    Jobs,
+    Quests,
+    Dialogue,
+    Hotspots,
+    Save,
+    TestSave,
+    TestHistory,
+    TestDirector,
+    Nav,
+    Text,
+    CheckAllocs,
+    CheckReplay,
+    CheckClock,
+    CheckSimThread,
+};
+
+struct BenchOptions
+{
+    BenchMode mode = BenchMode::None;
+    int count = 0;    // numeric argument of --bench-* and --test-*
+    std::string path; // replay file of --check-*
+};
+
+// Takes argv[i], and its value, when it names a mode. False for anything
+// else, including a second mode: one runs per process.
+bool ParseBenchArg(int argc, char **argv, int &i, BenchOptions &options);
+
+// "[--bench-particles <count>] ..." for the usage line.
+std::string BenchUsage();
+
+// False for --bench-jobs, which starts its own schedulers, and for the
+// replay checks, which stay on one thread like headless replay.
+bool BenchUsesWorkers(const BenchOptions &options);
+
+// Opens the pack at packPath first when the mode reads content.
+int RunBench(const BenchOptions &options, const std::string &packPath);
+
+// Plays the replay without a window and prints one "frame hash" line per
+// step, so two builds can be diffed for divergence.
+int RunHeadless(const ContentPack &content, const std::string &replayPath);
@@ -0,0 +1,191 @@
+#include "chronicle.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+
+static_assert((kChronicleQueueSize & (kChronicleQueueSize - 1u)) == 0, "queue size must be a power of two");
+
+void ChronicleLine::Assign(std::string_view line)
+{
+    const size_t n = std::min(line.size(), sizeof(text) - 1u);
+    std::memcpy(text, line.data(), n);
+    text[n] = '\0';
+    length = static_cast<uint16_t>(n);
+}
+
+Chronicle::~Chronicle()
+{
+    if (spill != nullptr)
+    {
+        std::fclose(spill);
+    }
+}
+
+bool Chronicle::OpenSpill(const std::string &path, size_t rotateBytes, int generations)
+{
+    if (spill != nullptr)
+    {
+        std::fclose(spill);
+        spill = nullptr;
+    }
+    spillPath = path;
+    spillBytes = 0;
+    spillRotateBytes = rotateBytes;
+    spillGenerations = std::max(generations, 1);
+
+    // The last session's log becomes generation 1 rather than being truncated.
+    if (std::FILE *previous = std::fopen(path.c_str(), "r"))
+    {
+        const bool empty = std::fgetc(previous) == EOF;
+        std::fclose(previous);
+        if (!empty)
+        {
+            RotateSpill();
+        }
+    }
+    spill = std::fopen(path.c_str(), "w");
+    return spill != nullptr;
+}
+
+// Shifts path.1..path.N-1 up one generation, drops path.N and moves the
+// current file to path.1. Names are built on the stack so a rotation during
+// Drain does not allocate.
+void Chronicle::RotateSpill()
+{
+    char from[512];
+    char to[512];
+    if (spillPath.size() + 12u > sizeof(from))
+    {
+        return;
+    }
+    std::snprintf(to, sizeof(to), "%s.%d", spillPath.c_str(), spillGenerations);
+    std::remove(to);
+    for (int generation = spillGenerations - 1; generation >= 1; --generation)
+    {
+        std::snprintf(from, sizeof(from), "%s.%d", spillPath.c_str(), generation);
+        std::rename(from, to);
+        std::memcpy(to, from, sizeof(to));
+    }
+    std::rename(spillPath.c_str(), to);
+}
+
+bool ChronicleQueue::Push(std::string_view line)
+{
+    if (line.empty())
+    {
+        return true;
+    }
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= kChronicleQueueSize)
+    {
+        dropped.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+    slots[h & (kChronicleQueueSize - 1u)].Assign(line);
+    head.store(h + 1u, std::memory_order_release);
+    return true;
+}
+
+bool ChronicleQueue::PushV(const char *format, std::va_list args)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= kChronicleQueueSize)
+    {
+        dropped.fetch_add(1u, std::memory_order_relaxed);
+        return false;
+    }
+    // Format straight into the slot; it is not visible until head moves.
+    ChronicleLine &slot = slots[h & (kChronicleQueueSize - 1u)];
+    const int written = std::vsnprintf(slot.text, sizeof(slot.text), format, args);
+    if (written <= 0)
+    {
+        return written == 0;
+    }
+    slot.length = static_cast<uint16_t>(std::min(static_cast<size_t>(written), sizeof(slot.text) - 1u));
+    head.store(h + 1u, std::memory_order_release);
+    return true;
+}
+
+bool Chronicle::Push(std::string_view line)
+{
+    return queue.Push(line);
+}
+
+bool Chronicle::Pushf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    const bool queued = queue.PushV(format, args);
+    va_end(args);
+    return queued;
+}
+
+void Chronicle::Drain()
+{
+    bool any = false;
+    queue.Consume([&](const ChronicleLine &line) {
+        Append(line);
+        Spill(line);
+        any = true;
+    });
+
+    const uint32_t lost = queue.TakeDropped();
+    if (lost > 0)
+    {
+        ChronicleLine note;
+        const int n = std::snprintf(note.text, sizeof(note.text), "CHRONICLE // %u lines dropped", static_cast<unsigned>(lost));
+        note.length = static_cast<uint16_t>(std::max(n, 0));
+        Append(note);
+        Spill(note);
+    }
+    if (spill != nullptr && (any || lost > 0))
+    {
+        std::fflush(spill);
+    }
+}
+
+const char *Chronicle::Line(size_t i) const
+{
+    if (i >= historyCount)
+    {
+        return "";
+    }
+    return history[(historyStart + i) % kChronicleHistory].text;
+}
+
+void Chronicle::Append(const ChronicleLine &line)
+{
+    ++revision;
+    if (historyCount < kChronicleHistory)
+    {
+        history[(historyStart + historyCount) % kChronicleHistory] = line;
+        ++historyCount;
+        return;
+    }
+    history[historyStart] = line;
+    historyStart = (historyStart + 1u) % kChronicleHistory;
+}
+
+void Chronicle::Spill(const ChronicleLine &line)
+{
+    if (spill == nullptr)
+    {
+        return;
+    }
+    if (spillRotateBytes > 0 && spillBytes + line.length + 1u > spillRotateBytes)
+    {
+        // A fixed number of generations keeps disk use bounded.
+        std::fclose(spill);
+        RotateSpill();
+        spill = std::fopen(spillPath.c_str(), "w");
+        spillBytes = 0;
+        if (spill == nullptr)
+        {
+            return;
+        }
+    }
+    std::fwrite(line.text, 1, line.length, spill);
+    std::fputc('\n', spill);
+    spillBytes += line.length + 1u;
+}
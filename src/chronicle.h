@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+constexpr size_t kChronicleLineBytes = 192;
+constexpr size_t kChronicleQueueSize = 128; // power of two
+constexpr size_t kChronicleHistory = 16;
+
+// One log line stored inline; longer text is truncated.
+struct ChronicleLine
+{
+    uint16_t length = 0;
+    char text[kChronicleLineBytes - sizeof(uint16_t)] = {};
+
+    void Assign(std::string_view line);
+};
+
+// Fixed-capacity ring of lines for one producer thread and one consumer
+// thread. The two sides only share the indices; nothing allocates. A push
+// into a full ring drops the line and counts it.
+class ChronicleQueue
+{
+public:
+    // Producer. Empty lines are ignored; returns false when the ring is full.
+    bool Push(std::string_view line);
+    bool PushV(const char *format, std::va_list args);
+
+    // Consumer. Calls fn(const ChronicleLine &) for every queued line.
+    template <typename Fn>
+    void Consume(Fn &&fn)
+    {
+        const uint32_t h = head.load(std::memory_order_acquire);
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        for (; t != h; ++t)
+        {
+            fn(slots[t & (kChronicleQueueSize - 1u)]);
+        }
+        tail.store(t, std::memory_order_release);
+    }
+    uint32_t TakeDropped() { return dropped.exchange(0u, std::memory_order_relaxed); }
+
+private:
+    ChronicleLine slots[kChronicleQueueSize];
+    alignas(64) std::atomic<uint32_t> head{0}; // next slot to write, producer-owned
+    alignas(64) std::atomic<uint32_t> tail{0}; // next slot to read, consumer-owned
+    alignas(64) std::atomic<uint32_t> dropped{0};
+};
+
+// Fixed-capacity chronicle. Push/Pushf are the producer side and Drain,
+// Size and Line the consumer side; the two sides only share the queue
+// indices, so one producer thread and one consumer thread can work without
+// locks. Nothing allocates after construction. Drained lines go to the
+// visible history window and, when open, to a rolling spill file. Full
+// files and the previous session's file move to numbered generations
+// (path.1 newest .. path.N oldest) instead of being overwritten.
+class Chronicle
+{
+public:
+    Chronicle() = default;
+    Chronicle(const Chronicle &) = delete;
+    Chronicle &operator=(const Chronicle &) = delete;
+    ~Chronicle();
+
+    bool OpenSpill(const std::string &path, size_t rotateBytes = 8u << 20, int generations = 8);
+
+    // Producer. Empty lines are ignored; returns false when the queue is full.
+    bool Push(std::string_view line);
+    bool Pushf(const char *format, ...);
+
+    // Consumer.
+    void Drain();
+    size_t Size() const { return historyCount; }
+    uint64_t Revision() const { return revision; } // bumps whenever history changes
+    const char *Line(size_t i) const; // 0 is the oldest visible line
+
+private:
+    void Append(const ChronicleLine &line);
+    void Spill(const ChronicleLine &line);
+    void RotateSpill();
+
+    ChronicleQueue queue;
+
+    ChronicleLine history[kChronicleHistory];
+    size_t historyStart = 0;
+    size_t historyCount = 0;
+    uint64_t revision = 0;
+
+    std::FILE *spill = nullptr;
+    std::string spillPath;
+    size_t spillBytes = 0;
+    size_t spillRotateBytes = 0;
+    int spillGenerations = 0;
+};
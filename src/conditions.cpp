@@ -0,0 +1,47 @@
+#include "conditions.h"
+
+bool EvaluateCondition(PackSpan<PackCondOp> program, const FlagSet &flags, const int (&stats)[static_cast<size_t>(PackStat::Count)])
+{
+    // Top of stack is bit 0.
+    uint64_t stack = 1u;
+    for (const PackCondOp &op : program)
+    {
+        const int stat = stats[op.stat < static_cast<uint8_t>(PackStat::Count) ? op.stat : 0u];
+        uint64_t value = 0u;
+        switch (static_cast<PackCondOpcode>(op.op))
+        {
+        case PackCondOpcode::Flag:
+            value = flags.Test(static_cast<FlagId>(op.arg));
+            break;
+        case PackCondOpcode::Not:
+            stack ^= 1u;
+            continue;
+        case PackCondOpcode::And:
+            stack = (stack >> 1) & (~uint64_t{1} | stack);
+            continue;
+        case PackCondOpcode::Or:
+            stack = (stack >> 1) | (stack & 1u);
+            continue;
+        case PackCondOpcode::Less:
+            value = stat < op.arg;
+            break;
+        case PackCondOpcode::LessEqual:
+            value = stat <= op.arg;
+            break;
+        case PackCondOpcode::Greater:
+            value = stat > op.arg;
+            break;
+        case PackCondOpcode::GreaterEqual:
+            value = stat >= op.arg;
+            break;
+        case PackCondOpcode::Equal:
+            value = stat == op.arg;
+            break;
+        case PackCondOpcode::NotEqual:
+            value = stat != op.arg;
+            break;
+        }
+        stack = (stack << 1) | value;
+    }
+    return (stack & 1u) != 0u;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "content_pack.h"
+#include "flags.h"
+
+// Runs a compiled condition (see PackCondOp). Stats are indexed by PackStat.
+// The bool stack lives in one register-sized word, so evaluation neither
+// allocates nor branches on intermediate results; an empty program is true.
+bool EvaluateCondition(PackSpan<PackCondOp> program, const FlagSet &flags, const int (&stats)[static_cast<size_t>(PackStat::Count)]);
@@ -0,0 +1,234 @@
+#include "content_pack.h"
+
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ContentPack::~ContentPack()
+{
+    Close();
+}
+
+bool ContentPack::Open(const std::string &path, std::string &error)
+{
+    Close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        error = "empty pack " + path;
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (mapping != nullptr)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        error = "cannot map " + path;
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info = {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        error = "empty pack " + path;
+        return false;
+    }
+    void *view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        error = "cannot map " + path;
+        return false;
+    }
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    // Only the header and section table are validated up front; record
+    // cross-references are bounds-checked by the accessors, so opening cost
+    // does not grow with the amount of content.
+    if (size < sizeof(PackHeader))
+    {
+        error = "truncated pack header";
+        Close();
+        return false;
+    }
+    const PackHeader &header = Header();
+    if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0)
+    {
+        error = "bad pack magic";
+        Close();
+        return false;
+    }
+    if (header.version != kPackVersion)
+    {
+        error = "pack version " + std::to_string(header.version) + ", expected " + std::to_string(kPackVersion);
+        Close();
+        return false;
+    }
+    if (header.fileSize != size || header.sectionCount != kPackSectionCount)
+    {
+        error = "pack size or section table mismatch";
+        Close();
+        return false;
+    }
+    for (size_t i = 0; i < kPackSectionCount; ++i)
+    {
+        const PackSection &section = header.sections[i];
+        const uint64_t bytes = static_cast<uint64_t>(section.count) * PackRecordSize(static_cast<PackSectionId>(i));
+        if (section.offset % 4u != 0u || section.offset < sizeof(PackHeader) || section.offset + bytes > size)
+        {
+            error = "pack section " + std::to_string(i) + " out of bounds";
+            Close();
+            return false;
+        }
+    }
+    const PackSection &strings = header.sections[static_cast<size_t>(PackSectionId::Strings)];
+    if (strings.count == 0 || data[strings.offset + strings.count - 1u] != '\0')
+    {
+        error = "pack string blob is not terminated";
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void ContentPack::Close()
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    ::munmap(const_cast<unsigned char *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+std::string_view ContentPack::Str(PackStr s) const
+{
+    const PackSpan<char> blob = Section<char>(PackSectionId::Strings);
+    if (s.offset >= blob.count || s.length >= blob.count - s.offset)
+    {
+        return {};
+    }
+    return std::string_view(blob.first + s.offset, s.length);
+}
+
+const char *ContentPack::CStr(PackStr s) const
+{
+    const std::string_view view = Str(s);
+    return view.empty() ? "" : view.data();
+}
+
+PackSpan<PackPoint> ContentPack::Points(const PackRing &ring) const
+{
+    return Slice<PackPoint>(PackSectionId::Points, ring.pointFirst, ring.pointCount);
+}
+
+PackSpan<PackRing> ContentPack::Holes(const PackScene &scene) const
+{
+    return Slice<PackRing>(PackSectionId::Rings, scene.holeFirst, scene.holeCount);
+}
+
+PackSpan<PackHotspot> ContentPack::Hotspots(const PackScene &scene) const
+{
+    return Slice<PackHotspot>(PackSectionId::Hotspots, scene.hotspotFirst, scene.hotspotCount);
+}
+
+PackSpan<PackLayer> ContentPack::Layers(const PackScene &scene) const
+{
+    return Slice<PackLayer>(PackSectionId::Layers, scene.layerFirst, scene.layerCount);
+}
+
+PackSpan<PackEmitter> ContentPack::Emitters(const PackScene &scene) const
+{
+    return Slice<PackEmitter>(PackSectionId::Emitters, scene.emitterFirst, scene.emitterCount);
+}
+
+PackSpan<PackImage> ContentPack::Images(const PackScene &scene) const
+{
+    return Slice<PackImage>(PackSectionId::Images, scene.imageFirst, scene.imageCount);
+}
+
+PackSpan<uint32_t> ContentPack::MaskBits(const PackHotspot &hotspot) const
+{
+    const uint32_t bits = static_cast<uint32_t>(hotspot.maskWidth) * hotspot.maskHeight;
+    return Slice<uint32_t>(PackSectionId::MaskBits, hotspot.maskFirst, (bits + 31u) / 32u);
+}
+
+PackSpan<PackChoice> ContentPack::Choices(const PackNode &node) const
+{
+    return Slice<PackChoice>(PackSectionId::Choices, node.choiceFirst, node.choiceCount);
+}
+
+PackSpan<PackCondOp> ContentPack::Condition(const PackChoice &choice) const
+{
+    return Slice<PackCondOp>(PackSectionId::Conditions, choice.condFirst, choice.condCount);
+}
+
+PackSpan<PackCondOp> ContentPack::Condition(const PackEvent &event) const
+{
+    return Slice<PackCondOp>(PackSectionId::Conditions, event.condFirst, event.condCount);
+}
+
+PackSpan<PackObjective> ContentPack::Objectives(const PackQuest &quest) const
+{
+    return Slice<PackObjective>(PackSectionId::Objectives, quest.objectiveFirst, quest.objectiveCount);
+}
+
+PackSpan<uint32_t> ContentPack::ObjectiveFlags(const PackObjective &objective) const
+{
+    return Slice<uint32_t>(PackSectionId::ObjectiveFlags, objective.flagFirst, objective.flagCount);
+}
+
+const PackNode *ContentPack::Node(int index) const
+{
+    const PackSpan<PackNode> nodes = Nodes();
+    if (index < 0 || static_cast<uint32_t>(index) >= nodes.size())
+    {
+        return nullptr;
+    }
+    return &nodes[static_cast<uint32_t>(index)];
+}
@@ -0,0 +1,452 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Binary content pack produced by tools/worldforge_pack from the text
+// source in content/. Every record is fixed-layout little-endian POD so the
+// runtime can map the file and read records where they lie. Strings live in
+// one NUL-terminated blob and are referenced by (offset, length).
+
+constexpr char kPackMagic[4] = {'W', 'F', 'C', 'P'};
+constexpr uint32_t kPackVersion = 9;
+constexpr uint32_t kPackNone = UINT32_MAX;
+
+enum class PackSectionId : uint32_t
+{
+    Strings,
+    Flags,
+    Scenes,
+    Points,
+    Rings,
+    Hotspots,
+    Nodes,
+    Choices,
+    Quests,
+    Objectives,
+    ObjectiveFlags,
+    Events,
+    Rules,
+    Reasons,
+    Pillars,
+    Layers,
+    Emitters,
+    Images,
+    MaskBits,
+    Conditions,
+    Count
+};
+
+constexpr size_t kPackSectionCount = static_cast<size_t>(PackSectionId::Count);
+
+struct PackSection
+{
+    uint32_t offset = 0;
+    uint32_t count = 0; // records, or bytes for the string blob
+};
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t sectionCount;
+    PackSection sections[kPackSectionCount];
+};
+
+struct PackStr
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct PackPoint
+{
+    float x;
+    float y;
+};
+
+struct PackRing
+{
+    uint32_t pointFirst;
+    uint32_t pointCount;
+};
+
+// Post-process settings for a scene. Effect strengths are 0..1 except
+// aberration (pixels at the screen edge). The grade is baked into a LUT:
+// saturation and contrast first, then each tint is mixed in by its alpha,
+// weighted toward the shadows or the highlights.
+struct PackPostFx
+{
+    float grain;
+    float scanlines;
+    float vignette;
+    float aberration;
+    float saturation;
+    float contrast;
+    uint8_t shadowTint[4];
+    uint8_t highlightTint[4];
+};
+
+struct PackScene
+{
+    PackStr id;
+    PackStr flavorText;
+    PackStr artDirection;
+    uint8_t topColor[4];
+    uint8_t bottomColor[4];
+    float cameraTarget[2];
+    float cameraOffsetNorm[2];
+    float cameraZoom;
+    PackRing walk;
+    uint32_t holeFirst;
+    uint32_t holeCount;
+    uint32_t hotspotFirst;
+    uint32_t hotspotCount;
+    uint32_t layerFirst;
+    uint32_t layerCount;
+    uint32_t emitterFirst;
+    uint32_t emitterCount;
+    uint32_t imageFirst;
+    uint32_t imageCount;
+    PackPostFx post;
+    float ambientBeat; // seconds between ambient event picks
+    float ambientJitter; // up to this much is added to each beat
+};
+
+enum class PackLayerPass : uint8_t
+{
+    Backdrop,
+    Light, // positioned relative to the player
+    Foreground,
+    Count
+};
+
+enum class PackLayerKind : uint8_t
+{
+    Rect,
+    Frame,
+    Glow,
+    Line
+};
+
+enum class PackLayerWave : uint8_t
+{
+    None,
+    X,
+    Y,
+    Size,
+    Alpha
+};
+
+// One render layer of a scene. Geometry slots hold frac * extent + px, with
+// slots 0/2 scaled by the target width and 1/3 by its height:
+// rect/frame x y w h, glow cx cy radius, line x0 y0 x1 y1.
+// The layer is drawn repeatCount times, stepping by repeatStep per index.
+struct PackLayer
+{
+    uint8_t pass;
+    uint8_t kind;
+    uint8_t wave;
+    uint8_t reserved;
+    uint8_t color[4];
+    float frac[4];
+    float px[4];
+    float thickness;
+    float waveAmp;
+    float waveFreq;
+    float wavePhaseStep;
+    int32_t repeatFirst;
+    uint32_t repeatCount;
+    float repeatStep[2];
+    float scrollSpeed;
+    float scrollPeriod;
+};
+
+// A particle emitter: a fixed budget of motes respawned inside the area
+// (same fraction-plus-pixels encoding as layers) with a base drift, a random
+// velocity spread and a lifetime range in seconds.
+struct PackEmitter
+{
+    uint32_t budget;
+    uint8_t color[4];
+    float size;
+    float areaFrac[4];
+    float areaPx[4];
+    float drift[2];
+    float jitter[2];
+    float life[2];
+    uint32_t seed;
+};
+
+// A painted image layer streamed at runtime. The path is relative to the
+// pack's directory; dest uses the layer fraction-plus-pixels encoding.
+struct PackImage
+{
+    PackStr path;
+    uint8_t pass;
+    uint8_t reserved[3];
+    float frac[4];
+    float px[4];
+};
+
+// Hotspots are rectangles, optionally narrowed by a polygon outline (points
+// in Points()) and/or a 1-bit mask stretched over the rectangle, stored
+// row-major as bits in MaskBits() words. Higher z picks first.
+struct PackHotspot
+{
+    float area[4];
+    PackStr label;
+    int32_t dialogueNode; // index into Nodes(), -1 for exits
+    PackStr transitionTo;
+    float spawn[2];
+    int32_t z;
+    PackRing outline;
+    uint32_t maskFirst;
+    uint16_t maskWidth;
+    uint16_t maskHeight; // 0 when there is no mask
+};
+
+enum class PackStat : uint8_t
+{
+    Composure,
+    CrewTrust,
+    Threat,
+    Count
+};
+
+enum class PackCondOpcode : uint8_t
+{
+    Flag, // push: flag arg is set
+    Not,
+    And,
+    Or,
+    Less, // push: stat < arg
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+// One instruction of a compiled condition. Conditions are postfix programs
+// over a bool stack, compiled by the packer from `when "<expr>"` and the
+// requires/blocks/threat shorthands; an empty program is always true.
+struct PackCondOp
+{
+    uint8_t op;
+    uint8_t stat; // PackStat for comparisons
+    uint16_t reserved;
+    int32_t arg; // flag id or comparison value
+};
+
+constexpr size_t kPackConditionDepth = 64; // the runtime stack is one 64-bit word
+
+struct PackNode
+{
+    int32_t id; // authored id, kept for debugging
+    PackStr speaker;
+    PackStr line;
+    uint32_t choiceFirst;
+    uint32_t choiceCount;
+};
+
+struct PackChoice
+{
+    PackStr text;
+    int32_t nextNode; // index into Nodes(), -1 ends the conversation
+    uint32_t setFlag;
+    uint32_t condFirst; // into Conditions()
+    uint32_t condCount;
+    PackStr startQuest;
+    int32_t composureDelta;
+    int32_t crewTrustDelta;
+    int32_t threatDelta;
+    PackStr consequenceLine;
+};
+
+struct PackQuest
+{
+    PackStr id;
+    PackStr title;
+    PackStr purpose;
+    uint32_t objectiveFirst;
+    uint32_t objectiveCount;
+};
+
+struct PackObjective
+{
+    PackStr text;
+    uint32_t flagFirst;
+    uint32_t flagCount;
+};
+
+// An ambient beat. On each scene beat the director fires the eligible event
+// with the highest priority (pack order breaks ties); it then rests for
+// cooldown plus up to jitter seconds. An empty scene means every scene.
+struct PackEvent
+{
+    PackStr id;
+    PackStr line;
+    uint32_t condFirst;
+    uint32_t condCount;
+    uint32_t grantsFlag;
+    uint32_t fireOnce;
+    int32_t priority;
+    float cooldown;
+    float jitter;
+    PackStr scene;
+};
+
+struct PackRule
+{
+    PackStr code;
+    PackStr text;
+};
+
+static_assert(sizeof(PackHeader) == 16 + 8 * kPackSectionCount, "pack header layout");
+static_assert(sizeof(PackScene) == 140, "pack scene layout");
+static_assert(sizeof(PackLayer) == 80, "pack layer layout");
+static_assert(sizeof(PackEmitter) == 72, "pack emitter layout");
+static_assert(sizeof(PackImage) == 44, "pack image layout");
+static_assert(sizeof(PackHotspot) == 64, "pack hotspot layout");
+static_assert(sizeof(PackNode) == 28, "pack node layout");
+static_assert(sizeof(PackChoice) == 52, "pack choice layout");
+static_assert(sizeof(PackCondOp) == 8, "pack condition layout");
+static_assert(sizeof(PackEvent) == 52, "pack event layout");
+
+inline size_t PackRecordSize(PackSectionId id)
+{
+    switch (id)
+    {
+    case PackSectionId::Strings:
+        return 1;
+    case PackSectionId::Flags:
+    case PackSectionId::Reasons:
+    case PackSectionId::Pillars:
+        return sizeof(PackStr);
+    case PackSectionId::Scenes:
+        return sizeof(PackScene);
+    case PackSectionId::Points:
+        return sizeof(PackPoint);
+    case PackSectionId::Rings:
+        return sizeof(PackRing);
+    case PackSectionId::Hotspots:
+        return sizeof(PackHotspot);
+    case PackSectionId::Nodes:
+        return sizeof(PackNode);
+    case PackSectionId::Choices:
+        return sizeof(PackChoice);
+    case PackSectionId::Quests:
+        return sizeof(PackQuest);
+    case PackSectionId::Objectives:
+        return sizeof(PackObjective);
+    case PackSectionId::ObjectiveFlags:
+    case PackSectionId::MaskBits:
+        return sizeof(uint32_t);
+    case PackSectionId::Events:
+        return sizeof(PackEvent);
+    case PackSectionId::Rules:
+        return sizeof(PackRule);
+    case PackSectionId::Layers:
+        return sizeof(PackLayer);
+    case PackSectionId::Emitters:
+        return sizeof(PackEmitter);
+    case PackSectionId::Images:
+        return sizeof(PackImage);
+    case PackSectionId::Conditions:
+        return sizeof(PackCondOp);
+    default:
+        return 0;
+    }
+}
+
+template <typename T>
+struct PackSpan
+{
+    const T *first = nullptr;
+    uint32_t count = 0;
+
+    const T *begin() const { return first; }
+    const T *end() const { return first + count; }
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T &operator[](uint32_t i) const { return first[i]; }
+};
+
+// Read-only view over a memory-mapped pack.
+class ContentPack
+{
+public:
+    ContentPack() = default;
+    ContentPack(const ContentPack &) = delete;
+    ContentPack &operator=(const ContentPack &) = delete;
+    ~ContentPack();
+
+    bool Open(const std::string &path, std::string &error);
+    void Close();
+    bool IsOpen() const { return data != nullptr; }
+    size_t SizeBytes() const { return size; }
+
+    std::string_view Str(PackStr s) const;
+    const char *CStr(PackStr s) const;
+
+    PackSpan<PackStr> Flags() const { return Section<PackStr>(PackSectionId::Flags); }
+    PackSpan<PackScene> Scenes() const { return Section<PackScene>(PackSectionId::Scenes); }
+    PackSpan<PackNode> Nodes() const { return Section<PackNode>(PackSectionId::Nodes); }
+    PackSpan<PackQuest> Quests() const { return Section<PackQuest>(PackSectionId::Quests); }
+    PackSpan<PackEvent> Events() const { return Section<PackEvent>(PackSectionId::Events); }
+    PackSpan<PackRule> Rules() const { return Section<PackRule>(PackSectionId::Rules); }
+    PackSpan<PackStr> Reasons() const { return Section<PackStr>(PackSectionId::Reasons); }
+    PackSpan<PackStr> Pillars() const { return Section<PackStr>(PackSectionId::Pillars); }
+
+    PackSpan<PackPoint> Points(const PackRing &ring) const;
+    PackSpan<PackRing> Holes(const PackScene &scene) const;
+    PackSpan<PackHotspot> Hotspots(const PackScene &scene) const;
+    PackSpan<PackLayer> Layers(const PackScene &scene) const;
+    PackSpan<PackEmitter> Emitters(const PackScene &scene) const;
+    PackSpan<PackImage> Images(const PackScene &scene) const;
+    PackSpan<uint32_t> MaskBits(const PackHotspot &hotspot) const;
+    PackSpan<PackChoice> Choices(const PackNode &node) const;
+    PackSpan<PackCondOp> Condition(const PackChoice &choice) const;
+    PackSpan<PackCondOp> Condition(const PackEvent &event) const;
+    PackSpan<PackObjective> Objectives(const PackQuest &quest) const;
+    PackSpan<uint32_t> ObjectiveFlags(const PackObjective &objective) const;
+
+    // Dialogue references are resolved to dense node indices at pack time.
+    const PackNode *Node(int index) const;
+
+private:
+    template <typename T>
+    PackSpan<T> Section(PackSectionId id) const
+    {
+        if (data == nullptr)
+        {
+            return {};
+        }
+        const PackSection &section = Header().sections[static_cast<size_t>(id)];
+        return PackSpan<T>{reinterpret_cast<const T *>(data + section.offset), section.count};
+    }
+
+    template <typename T>
+    PackSpan<T> Slice(PackSectionId id, uint32_t first, uint32_t count) const
+    {
+        const PackSpan<T> all = Section<T>(id);
+        if (first > all.count || count > all.count - first)
+        {
+            return {};
+        }
+        return PackSpan<T>{all.first + first, count};
+    }
+
+    const PackHeader &Header() const { return *reinterpret_cast<const PackHeader *>(data); }
+
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,49 @@
+#include "dialogue_panel.h"
+
+Rectangle ChoiceButton(uint32_t index, int screenWidth, int screenHeight)
+{
+    return Rectangle{
+        46.0f,
+        static_cast<float>(screenHeight - 156 + static_cast<int>(index) * 36),
+        static_cast<float>(screenWidth - 92),
+        30.0f};
+}
+
+void DrawDialoguePanel(const ContentPack &content, int nodeIndex, const std::vector<uint8_t> &choiceUnlocked,
+                       TextLayoutCache &textCache, int screenWidth, int screenHeight)
+{
+    const PackNode *nodeRecord = content.Node(nodeIndex);
+    if (nodeRecord == nullptr)
+    {
+        return;
+    }
+    const PackNode &node = *nodeRecord;
+    const PackSpan<PackChoice> choices = content.Choices(node);
+    const Rectangle panel{30.0f, static_cast<float>(screenHeight - 270), static_cast<float>(screenWidth - 60), 244.0f};
+    DrawRectangleRec(panel, Color{7, 8, 10, 236});
+    DrawRectangleLinesEx(panel, 1.8f, Color{125, 157, 180, 255});
+
+    textCache.Draw(content, node.speaker, Vector2{panel.x + 16.0f, panel.y + 14.0f}, 22, Color{246, 188, 128, 255});
+    textCache.Draw(content, node.line, Vector2{panel.x + 16.0f, panel.y + 46.0f}, 19, RAYWHITE, panel.width - 32.0f);
+
+    for (uint32_t i = 0; i < choices.size(); ++i)
+    {
+        const PackChoice &c = choices[i];
+        const bool unlocked = i < choiceUnlocked.size() && choiceUnlocked[i] != 0u;
+        const Rectangle btn = ChoiceButton(i, screenWidth, screenHeight);
+        const bool hover = CheckCollisionPointRec(GetMousePosition(), btn);
+
+        const Color base = !unlocked ? Color{20, 20, 24, 200}
+                                     : (hover ? Color{58, 76, 88, 255} : Color{32, 42, 52, 255});
+        const Color border = !unlocked ? Color{72, 72, 82, 200} : Color{132, 154, 172, 255};
+        DrawRectangleRec(btn, base);
+        DrawRectangleLinesEx(btn, 1.0f, border);
+
+        const Color textColor = unlocked ? RAYWHITE : Color{130, 130, 142, 255};
+        const Vector2 labelSize = textCache.Draw(content, c.text, Vector2{btn.x + 8.0f, btn.y + 6.0f}, 16, textColor);
+        if (!unlocked)
+        {
+            textCache.Draw(" [LOCKED]", Vector2{btn.x + 8.0f + labelSize.x, btn.y + 6.0f}, 16, textColor);
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "content_pack.h"
+#include "text_layout.h"
+
+#include <cstdint>
+#include <vector>
+
+// Screen rectangle of the index-th choice button; clicks are tested
+// against the same rectangles the panel draws.
+Rectangle ChoiceButton(uint32_t index, int screenWidth, int screenHeight);
+
+// Speaker, wrapped line and one button per choice of the open node. Shared
+// by the window loop and --check-allocs, so the check draws what players see.
+void DrawDialoguePanel(const ContentPack &content, int nodeIndex, const std::vector<uint8_t> &choiceUnlocked,
+                       TextLayoutCache &textCache, int screenWidth, int screenHeight);
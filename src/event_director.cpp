@@ -0,0 +1,401 @@
+#include "event_director.h"
+
+#include "conditions.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TimerWheel::Reset()
+{
+    for (uint32_t s = 0; s < kSlots; ++s)
+    {
+        inner[s].clear();
+        outer[s].clear();
+    }
+    overflow.clear();
+    now = 0;
+    carry = 0.0f;
+}
+
+void TimerWheel::Insert(const Timer &timer)
+{
+    if (timer.due < now + kSlots)
+    {
+        // Due this tick lands in the slot about to be expired.
+        inner[std::max(timer.due, now) & (kSlots - 1u)].push_back(timer);
+    }
+    else if ((timer.due >> kSlotBits) - (now >> kSlotBits) < kSlots)
+    {
+        outer[(timer.due >> kSlotBits) & (kSlots - 1u)].push_back(timer);
+    }
+    else
+    {
+        overflow.push_back(timer);
+    }
+}
+
+void TimerWheel::Schedule(uint32_t id, float delaySeconds)
+{
+    const float ticks = std::ceil(delaySeconds / kTickSeconds);
+    Insert(Timer{id, now + static_cast<uint64_t>(std::max(ticks, 1.0f))});
+}
+
+void TimerWheel::Advance(float dt, std::vector<uint32_t> &expired)
+{
+    carry += dt;
+    while (carry >= kTickSeconds)
+    {
+        carry -= kTickSeconds;
+        ++now;
+        const uint32_t slot = static_cast<uint32_t>(now & (kSlots - 1u));
+        if (slot == 0u)
+        {
+            const uint64_t block = now >> kSlotBits;
+            if ((block & (kSlots - 1u)) == 0u)
+            {
+                scratch.swap(overflow);
+                for (const Timer &timer : scratch)
+                {
+                    Insert(timer);
+                }
+                scratch.clear();
+            }
+            scratch.swap(outer[block & (kSlots - 1u)]);
+            for (const Timer &timer : scratch)
+            {
+                Insert(timer);
+            }
+            scratch.clear();
+        }
+        for (const Timer &timer : inner[slot])
+        {
+            expired.push_back(timer.id);
+        }
+        inner[slot].clear();
+    }
+}
+
+static bool IsComparison(PackCondOpcode op)
+{
+    return op != PackCondOpcode::Flag && op != PackCondOpcode::Not && op != PackCondOpcode::And && op != PackCondOpcode::Or;
+}
+
+void EventDirector::Build(const ContentPack &pack, size_t flagCount)
+{
+    content = &pack;
+    const PackSpan<PackEvent> events = pack.Events();
+    const uint32_t count = static_cast<uint32_t>(events.size());
+
+    priority.assign(count, 0);
+    sceneOf.assign(count, kAnyScene);
+    sceneNames.clear();
+    for (uint32_t s = 0; s < kStatCount; ++s)
+    {
+        cuts[s].clear();
+        statEvents[s].clear();
+    }
+
+    std::vector<uint32_t> flagCounts(flagCount + 1u, 0u);
+    const auto forEachWatch = [&](auto &&visit)
+    {
+        for (uint32_t e = 0; e < count; ++e)
+        {
+            for (const PackCondOp &op : pack.Condition(events[e]))
+            {
+                if (static_cast<PackCondOpcode>(op.op) == PackCondOpcode::Flag && static_cast<uint32_t>(op.arg) < flagCount)
+                {
+                    visit(static_cast<FlagId>(op.arg), e);
+                }
+            }
+            if (events[e].fireOnce != 0u && events[e].grantsFlag < flagCount)
+            {
+                visit(events[e].grantsFlag, e);
+            }
+        }
+    };
+    forEachWatch([&](FlagId id, uint32_t)
+                 { ++flagCounts[id]; });
+    flagStart.assign(flagCount + 1u, 0u);
+    for (size_t f = 0; f < flagCount; ++f)
+    {
+        flagStart[f + 1u] = flagStart[f] + flagCounts[f];
+    }
+    flagEvents.resize(flagStart[flagCount]);
+    std::fill(flagCounts.begin(), flagCounts.end(), 0u);
+    forEachWatch([&](FlagId id, uint32_t e)
+                 { flagEvents[flagStart[id] + flagCounts[id]++] = e; });
+
+    for (uint32_t e = 0; e < count; ++e)
+    {
+        const PackEvent &event = events[e];
+        priority[e] = event.priority;
+        const std::string_view scene = pack.Str(event.scene);
+        if (!scene.empty())
+        {
+            const auto it = std::find(sceneNames.begin(), sceneNames.end(), scene);
+            sceneOf[e] = static_cast<uint32_t>(it - sceneNames.begin());
+            if (it == sceneNames.end())
+            {
+                sceneNames.push_back(scene);
+            }
+        }
+        // A comparison against c can only change its answer between c - 1
+        // and c or between c and c + 1, so those are the band edges.
+        for (const PackCondOp &op : pack.Condition(event))
+        {
+            if (!IsComparison(static_cast<PackCondOpcode>(op.op)) || op.stat >= kStatCount)
+            {
+                continue;
+            }
+            cuts[op.stat].push_back(op.arg);
+            cuts[op.stat].push_back(op.arg + 1);
+            if (statEvents[op.stat].empty() || statEvents[op.stat].back() != e)
+            {
+                statEvents[op.stat].push_back(e);
+            }
+        }
+    }
+    for (uint32_t s = 0; s < kStatCount; ++s)
+    {
+        std::sort(cuts[s].begin(), cuts[s].end());
+        cuts[s].erase(std::unique(cuts[s].begin(), cuts[s].end()), cuts[s].end());
+    }
+
+    const uint32_t sceneCount = static_cast<uint32_t>(sceneNames.size());
+    sceneStart.assign(sceneCount + 1u, 0u);
+    for (uint32_t e = 0; e < count; ++e)
+    {
+        if (sceneOf[e] != kAnyScene)
+        {
+            ++sceneStart[sceneOf[e] + 1u];
+        }
+    }
+    for (uint32_t s = 0; s < sceneCount; ++s)
+    {
+        sceneStart[s + 1u] += sceneStart[s];
+    }
+    sceneEvents.resize(sceneStart[sceneCount]);
+    std::vector<uint32_t> sceneFill(sceneStart.begin(), sceneStart.end() - 1);
+    for (uint32_t e = 0; e < count; ++e)
+    {
+        if (sceneOf[e] != kAnyScene)
+        {
+            sceneEvents[sceneFill[sceneOf[e]]++] = e;
+        }
+    }
+
+    heap.clear();
+    heap.reserve(count);
+    heapPos.assign(count, -1);
+    cooling.assign(count, 0u);
+    dirtyMark.assign(count, 0u);
+    dirty.clear();
+    wheel.Reset();
+    Invalidate();
+}
+
+void EventDirector::MarkDirty(uint32_t event)
+{
+    if (dirtyMark[event] == 0u)
+    {
+        dirtyMark[event] = 1u;
+        dirty.push_back(event);
+    }
+}
+
+void EventDirector::MarkRange(const std::vector<uint32_t> &start, const std::vector<uint32_t> &list, uint32_t key)
+{
+    for (uint32_t i = start[key]; i < start[key + 1u]; ++i)
+    {
+        MarkDirty(list[i]);
+    }
+}
+
+void EventDirector::NotifyFlag(FlagId id)
+{
+    if (id + 1u < flagStart.size())
+    {
+        MarkRange(flagStart, flagEvents, id);
+    }
+}
+
+void EventDirector::Invalidate()
+{
+    for (uint32_t e = 0; e < dirtyMark.size(); ++e)
+    {
+        MarkDirty(e);
+    }
+    sceneKnown = false;
+    bandsKnown = false;
+}
+
+void EventDirector::Advance(float dt)
+{
+    wheel.Advance(dt, expired);
+    for (const uint32_t event : expired)
+    {
+        cooling[event] = 0u;
+        MarkDirty(event);
+    }
+    expired.clear();
+}
+
+uint32_t EventDirector::Band(uint32_t stat, int value) const
+{
+    return static_cast<uint32_t>(std::upper_bound(cuts[stat].begin(), cuts[stat].end(), value) - cuts[stat].begin());
+}
+
+int EventDirector::Pick(std::string_view sceneId, const FlagSet &flags, const int (&stats)[static_cast<size_t>(PackStat::Count)])
+{
+    if (!sceneKnown || sceneId != currentSceneId)
+    {
+        if (sceneKnown && currentScene != kAnyScene)
+        {
+            MarkRange(sceneStart, sceneEvents, currentScene);
+        }
+        const auto it = std::find(sceneNames.begin(), sceneNames.end(), sceneId);
+        currentScene = it == sceneNames.end() ? kAnyScene : static_cast<uint32_t>(it - sceneNames.begin());
+        currentSceneId.assign(sceneId.data(), sceneId.size());
+        if (currentScene != kAnyScene)
+        {
+            MarkRange(sceneStart, sceneEvents, currentScene);
+        }
+        sceneKnown = true;
+    }
+    for (uint32_t s = 0; s < kStatCount; ++s)
+    {
+        const uint32_t b = Band(s, stats[s]);
+        if (bandsKnown && b == band[s])
+        {
+            continue;
+        }
+        band[s] = b;
+        for (const uint32_t event : statEvents[s])
+        {
+            MarkDirty(event);
+        }
+    }
+    bandsKnown = true;
+
+    const PackSpan<PackEvent> events = content->Events();
+    for (const uint32_t e : dirty)
+    {
+        dirtyMark[e] = 0u;
+        const PackEvent &event = events[e];
+        const bool eligible = cooling[e] == 0u && (sceneOf[e] == kAnyScene || sceneOf[e] == currentScene) &&
+                              !(event.fireOnce != 0u && flags.Test(event.grantsFlag)) &&
+                              EvaluateCondition(content->Condition(event), flags, stats);
+        if (eligible && heapPos[e] < 0)
+        {
+            HeapInsert(e);
+        }
+        else if (!eligible && heapPos[e] >= 0)
+        {
+            HeapRemove(e);
+        }
+    }
+    dirty.clear();
+    return heap.empty() ? -1 : static_cast<int>(heap.front());
+}
+
+void EventDirector::Fired(uint32_t event)
+{
+    const PackEvent &record = content->Events()[event];
+    const float delay = record.cooldown + Jitter(record.jitter);
+    if (delay > 0.0f)
+    {
+        cooling[event] = 1u;
+        if (heapPos[event] >= 0)
+        {
+            HeapRemove(event);
+        }
+        wheel.Schedule(event, delay);
+    }
+    MarkDirty(event);
+}
+
+float EventDirector::Jitter(float range)
+{
+    if (range <= 0.0f)
+    {
+        return 0.0f;
+    }
+    // xorshift64*: same seed, same sequence, so replays stay deterministic.
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    const uint64_t bits = (rng * 0x2545f4914f6cdd1dull) >> 40;
+    return range * static_cast<float>(bits) / static_cast<float>(1u << 24);
+}
+
+bool EventDirector::Before(uint32_t a, uint32_t b) const
+{
+    return priority[a] != priority[b] ? priority[a] > priority[b] : a < b;
+}
+
+void EventDirector::SiftUp(uint32_t at)
+{
+    const uint32_t event = heap[at];
+    while (at > 0u)
+    {
+        const uint32_t parent = (at - 1u) / 2u;
+        if (!Before(event, heap[parent]))
+        {
+            break;
+        }
+        heap[at] = heap[parent];
+        heapPos[heap[at]] = static_cast<int32_t>(at);
+        at = parent;
+    }
+    heap[at] = event;
+    heapPos[event] = static_cast<int32_t>(at);
+}
+
+void EventDirector::SiftDown(uint32_t at)
+{
+    const uint32_t size = static_cast<uint32_t>(heap.size());
+    const uint32_t event = heap[at];
+    for (;;)
+    {
+        uint32_t child = at * 2u + 1u;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1u < size && Before(heap[child + 1u], heap[child]))
+        {
+            ++child;
+        }
+        if (!Before(heap[child], event))
+        {
+            break;
+        }
+        heap[at] = heap[child];
+        heapPos[heap[at]] = static_cast<int32_t>(at);
+        at = child;
+    }
+    heap[at] = event;
+    heapPos[event] = static_cast<int32_t>(at);
+}
+
+void EventDirector::HeapInsert(uint32_t event)
+{
+    heap.push_back(event);
+    SiftUp(static_cast<uint32_t>(heap.size() - 1u));
+}
+
+void EventDirector::HeapRemove(uint32_t event)
+{
+    const uint32_t at = static_cast<uint32_t>(heapPos[event]);
+    heapPos[event] = -1;
+    const uint32_t last = heap.back();
+    heap.pop_back();
+    if (last == event)
+    {
+        return;
+    }
+    heap[at] = last;
+    heapPos[last] = static_cast<int32_t>(at);
+    SiftUp(at);
+    SiftDown(static_cast<uint32_t>(heapPos[last]));
+}
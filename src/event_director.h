@@ -0,0 +1,116 @@
+#pragma once
+
+#include "content_pack.h"
+#include "flags.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Two-level hashed timer wheel in 1/16 s ticks: 64 slots of one tick, then 64
+// slots of 64 ticks, then an overflow list for anything past ~4 minutes.
+// Schedule is O(1); Advance only touches the slots it passes, cascading an
+// upper slot down when the lower wheel wraps.
+class TimerWheel
+{
+public:
+    static constexpr float kTickSeconds = 1.0f / 16.0f;
+
+    void Reset();
+    void Schedule(uint32_t id, float delaySeconds);
+
+    // Moves time forward and appends every id that came due to expired.
+    void Advance(float dt, std::vector<uint32_t> &expired);
+
+private:
+    struct Timer
+    {
+        uint32_t id = 0;
+        uint64_t due = 0; // absolute tick
+    };
+
+    static constexpr uint32_t kSlots = 64;
+    static constexpr uint32_t kSlotBits = 6;
+
+    void Insert(const Timer &timer);
+
+    std::vector<Timer> inner[kSlots];
+    std::vector<Timer> outer[kSlots];
+    std::vector<Timer> overflow;
+    std::vector<Timer> scratch;
+    uint64_t now = 0; // ticks processed
+    float carry = 0.0f;
+};
+
+// Picks ambient events. Eligible events sit in a heap ordered by priority,
+// then pack order, so a pick is the heap top. Eligibility is only rechecked
+// for events something could have changed for: a watched flag gained, a
+// watched stat crossing one of its condition thresholds, the scene changing
+// for scene-bound events, or a cooldown running out. Beats with nothing new
+// cost a few comparisons regardless of how many events the pack holds.
+class EventDirector
+{
+public:
+    void Build(const ContentPack &content, size_t flagCount);
+
+    void NotifyFlag(FlagId id);
+    void Invalidate(); // recheck everything, e.g. after a load or rewind
+
+    // Runs cooldowns forward; call every frame.
+    void Advance(float dt);
+
+    // Brings the heap up to date and returns the event to fire, or -1.
+    int Pick(std::string_view sceneId, const FlagSet &flags, const int (&stats)[static_cast<size_t>(PackStat::Count)]);
+
+    // Takes event out of rotation for its cooldown plus jitter.
+    void Fired(uint32_t event);
+
+    // Deterministic draw in [0, range) for beat and cooldown jitter.
+    float Jitter(float range);
+
+private:
+    static constexpr uint32_t kStatCount = static_cast<uint32_t>(PackStat::Count);
+    static constexpr uint32_t kAnyScene = UINT32_MAX;
+
+    bool Before(uint32_t a, uint32_t b) const;
+    void HeapInsert(uint32_t event);
+    void HeapRemove(uint32_t event);
+    void SiftUp(uint32_t at);
+    void SiftDown(uint32_t at);
+    void MarkDirty(uint32_t event);
+    void MarkRange(const std::vector<uint32_t> &start, const std::vector<uint32_t> &list, uint32_t key);
+    uint32_t Band(uint32_t stat, int value) const;
+
+    const ContentPack *content = nullptr;
+    std::vector<int32_t> priority;
+    std::vector<uint32_t> sceneOf; // index into sceneNames, or kAnyScene
+    std::vector<std::string_view> sceneNames;
+
+    // Flag -> events and scene -> events, CSR like QuestTracker.
+    std::vector<uint32_t> flagStart;
+    std::vector<uint32_t> flagEvents;
+    std::vector<uint32_t> sceneStart;
+    std::vector<uint32_t> sceneEvents;
+
+    // Per stat: sorted values where some condition flips, and the events
+    // that compare against that stat.
+    std::vector<int> cuts[kStatCount];
+    std::vector<uint32_t> statEvents[kStatCount];
+    uint32_t band[kStatCount] = {};
+
+    std::vector<uint32_t> heap;
+    std::vector<int32_t> heapPos; // -1 when not eligible
+    std::vector<uint8_t> cooling;
+    std::vector<uint8_t> dirtyMark;
+    std::vector<uint32_t> dirty;
+    std::vector<uint32_t> expired;
+    TimerWheel wheel;
+
+    uint32_t currentScene = kAnyScene;
+    std::string currentSceneId;
+    bool sceneKnown = false;
+    bool bandsKnown = false;
+    uint64_t rng = 0x9e3779b97f4a7c15ull;
+};
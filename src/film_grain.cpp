@@ -0,0 +1,137 @@
+#include "film_grain.h"
+
+#include "noise.h"
+
+#include <algorithm>
+#include <vector>
+
+static constexpr int kScanlinePeriod = 4;
+static constexpr Color kGrainColor{242, 248, 255, 16};
+static constexpr Color kScanlineColor{0, 0, 0, 20};
+
+bool LoadFilmGrain(FilmGrain &grain, int tileSize, int frameCount)
+{
+    UnloadFilmGrain(grain);
+    if (tileSize <= 0 || frameCount <= 0)
+    {
+        return false;
+    }
+
+    // Density matches the old sampler: every third row, every sixth column,
+    // one hit in 32 -> roughly one lit pixel in 576.
+    std::vector<Color> noise(static_cast<size_t>(tileSize) * static_cast<size_t>(tileSize * frameCount), BLANK);
+    for (int f = 0; f < frameCount; ++f)
+    {
+        for (int y = 0; y < tileSize; ++y)
+        {
+            Color *row = noise.data() + static_cast<size_t>(f * tileSize + y) * static_cast<size_t>(tileSize);
+            for (int x = 0; x < tileSize; ++x)
+            {
+                if (HashNoise(x, y, f) % 576u == 0u)
+                {
+                    row[x] = kGrainColor;
+                }
+            }
+        }
+    }
+
+    Image noiseImage{};
+    noiseImage.data = noise.data();
+    noiseImage.width = tileSize;
+    noiseImage.height = tileSize * frameCount;
+    noiseImage.mipmaps = 1;
+    noiseImage.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    grain.noiseAtlas = LoadTextureFromImage(noiseImage);
+
+    Color scan[kScanlinePeriod * kScanlinePeriod];
+    for (int y = 0; y < kScanlinePeriod; ++y)
+    {
+        for (int x = 0; x < kScanlinePeriod; ++x)
+        {
+            scan[y * kScanlinePeriod + x] = (y == 0) ? kScanlineColor : BLANK;
+        }
+    }
+    Image scanImage{};
+    scanImage.data = scan;
+    scanImage.width = kScanlinePeriod;
+    scanImage.height = kScanlinePeriod;
+    scanImage.mipmaps = 1;
+    scanImage.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    grain.scanlineTile = LoadTextureFromImage(scanImage);
+
+    if (grain.noiseAtlas.id == 0 || grain.scanlineTile.id == 0)
+    {
+        UnloadFilmGrain(grain);
+        return false;
+    }
+
+    SetTextureWrap(grain.noiseAtlas, TEXTURE_WRAP_REPEAT);
+    SetTextureFilter(grain.noiseAtlas, TEXTURE_FILTER_POINT);
+    SetTextureWrap(grain.scanlineTile, TEXTURE_WRAP_REPEAT);
+    SetTextureFilter(grain.scanlineTile, TEXTURE_FILTER_POINT);
+
+    grain.tileSize = tileSize;
+    grain.frameCount = frameCount;
+    grain.ready = true;
+    return true;
+}
+
+void UnloadFilmGrain(FilmGrain &grain)
+{
+    if (grain.noiseAtlas.id != 0)
+    {
+        UnloadTexture(grain.noiseAtlas);
+    }
+    if (grain.scanlineTile.id != 0)
+    {
+        UnloadTexture(grain.scanlineTile);
+    }
+    grain = FilmGrain{};
+}
+
+void DrawScanlines(const FilmGrain &grain, int w, int h)
+{
+    if (!grain.ready)
+    {
+        return;
+    }
+
+    const Rectangle source{0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)};
+    const Rectangle dest{0.0f, 0.0f, static_cast<float>(w), static_cast<float>(h)};
+    DrawTexturePro(grain.scanlineTile, source, dest, Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+void DrawFilmGrain(const FilmGrain &grain, int w, int h, int frame)
+{
+    if (!grain.ready)
+    {
+        return;
+    }
+
+    // Each frame picks an atlas tile and a pseudo-random phase inside it; the
+    // same frame counter always lands on the same tile and phase.
+    const int tile = grain.tileSize;
+    const uint32_t n = HashNoise(frame, frame * 7, 0x9e37);
+    const int atlasFrame = static_cast<int>(static_cast<uint32_t>(frame) % static_cast<uint32_t>(grain.frameCount));
+    const int offsetX = static_cast<int>(n % static_cast<uint32_t>(tile));
+    const int offsetY = static_cast<int>((n >> 12u) % static_cast<uint32_t>(tile));
+    const float atlasTop = static_cast<float>(atlasFrame * tile);
+
+    // Strips wrap horizontally inside their tile row; vertically we step one
+    // tile at a time so sampling never bleeds into the neighbouring frame.
+    int y = 0;
+    int rowInTile = offsetY;
+    while (y < h)
+    {
+        const int rows = std::min(tile - rowInTile, h - y);
+        const Rectangle source{
+            static_cast<float>(offsetX),
+            atlasTop + static_cast<float>(rowInTile),
+            static_cast<float>(w),
+            static_cast<float>(rows)};
+        const Rectangle dest{0.0f, static_cast<float>(y), static_cast<float>(w), static_cast<float>(rows)};
+        DrawTexturePro(grain.noiseAtlas, source, dest, Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+        y += rows;
+        rowInTile = 0;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "raylib.h"
+
+// Grain and scanlines baked once into small repeating textures. The noise
+// atlas stacks `frameCount` square tiles vertically so each frame can be
+// drawn as a handful of horizontally wrapping strips.
+struct FilmGrain
+{
+    Texture2D noiseAtlas{};
+    Texture2D scanlineTile{};
+    int tileSize = 0;
+    int frameCount = 0;
+    bool ready = false;
+};
+
+bool LoadFilmGrain(FilmGrain &grain, int tileSize = 256, int frameCount = 6);
+void UnloadFilmGrain(FilmGrain &grain);
+
+void DrawScanlines(const FilmGrain &grain, int w, int h);
+void DrawFilmGrain(const FilmGrain &grain, int w, int h, int frame);
@@ -0,0 +1,129 @@
+#include "flags.h"
+
+#include <algorithm>
+
+FlagId FlagRegistry::Intern(const std::string &name)
+{
+    const auto it = ids.find(name);
+    if (it != ids.end())
+    {
+        return it->second;
+    }
+    const FlagId id = static_cast<FlagId>(names.size());
+    ids.emplace(name, id);
+    names.push_back(name);
+    return id;
+}
+
+const std::string &FlagRegistry::Name(FlagId id) const
+{
+    static const std::string empty;
+    return id < names.size() ? names[id] : empty;
+}
+
+void FlagMask::Add(FlagId id)
+{
+    if (id == kNoFlag)
+    {
+        return;
+    }
+    const uint32_t word = id / 64u;
+    const uint64_t bit = uint64_t{1} << (id % 64u);
+    for (auto &entry : words)
+    {
+        if (entry.first == word)
+        {
+            entry.second |= bit;
+            return;
+        }
+    }
+    words.emplace_back(word, bit);
+    std::sort(words.begin(), words.end());
+}
+
+void FlagSet::Reserve(size_t flagCount)
+{
+    const size_t wordCount = (flagCount + 63u) / 64u;
+    if (bits.size() < wordCount)
+    {
+        bits.resize(wordCount, 0u);
+    }
+}
+
+void FlagSet::Clear()
+{
+    std::fill(bits.begin(), bits.end(), 0u);
+    count = 0;
+}
+
+void FlagSet::AssignWords(const std::vector<uint64_t> &words)
+{
+    std::fill(bits.begin(), bits.end(), 0u);
+    if (bits.size() < words.size())
+    {
+        bits.resize(words.size(), 0u);
+    }
+    std::copy(words.begin(), words.end(), bits.begin());
+    count = 0;
+    for (uint64_t word : words)
+    {
+        for (; word != 0u; word &= word - 1u)
+        {
+            ++count;
+        }
+    }
+}
+
+bool FlagSet::Test(FlagId id) const
+{
+    const size_t word = id / 64u;
+    return word < bits.size() && ((bits[word] >> (id % 64u)) & 1u) != 0u;
+}
+
+bool FlagSet::Set(FlagId id)
+{
+    if (id == kNoFlag)
+    {
+        return false;
+    }
+    const size_t word = id / 64u;
+    if (word >= bits.size())
+    {
+        bits.resize(word + 1u, 0u);
+    }
+    const uint64_t bit = uint64_t{1} << (id % 64u);
+    if ((bits[word] & bit) != 0u)
+    {
+        return false;
+    }
+    bits[word] |= bit;
+    ++count;
+    return true;
+}
+
+bool FlagSet::Any(const FlagMask &mask) const
+{
+    for (const auto &entry : mask.words)
+    {
+        if (entry.first < bits.size() && (bits[entry.first] & entry.second) != 0u)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned FlagSet::CountTrailingZeros(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+    unsigned n = 0;
+    while ((word & 1u) == 0u)
+    {
+        word >>= 1u;
+        ++n;
+    }
+    return n;
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using FlagId = uint32_t;
+constexpr FlagId kNoFlag = UINT32_MAX;
+
+// Maps flag names to dense ids. Names are interned once at content load;
+// everything on the frame path works with ids.
+class FlagRegistry
+{
+public:
+    FlagId Intern(const std::string &name);
+    const std::string &Name(FlagId id) const;
+    size_t Size() const { return names.size(); }
+
+private:
+    std::unordered_map<std::string, FlagId> ids;
+    std::vector<std::string> names;
+};
+
+// Sparse list of (word, bits) pairs, built from pack flag ids at load.
+struct FlagMask
+{
+    std::vector<std::pair<uint32_t, uint64_t>> words;
+
+    void Add(FlagId id);
+};
+
+class FlagSet
+{
+public:
+    void Reserve(size_t flagCount);
+    void Clear();
+
+    bool Test(FlagId id) const;
+    bool Set(FlagId id);
+    bool Any(const FlagMask &mask) const;
+    size_t Count() const { return count; }
+
+    // Raw 64-bit words, flag id = word * 64 + bit. Used to snapshot and
+    // restore the whole set at once.
+    const std::vector<uint64_t> &Words() const { return bits; }
+    void AssignWords(const std::vector<uint64_t> &words);
+
+    template <typename Fn>
+    void ForEach(Fn &&fn) const
+    {
+        for (size_t w = 0; w < bits.size(); ++w)
+        {
+            uint64_t word = bits[w];
+            while (word != 0u)
+            {
+                const unsigned bit = CountTrailingZeros(word);
+                fn(static_cast<FlagId>(w * 64u + bit));
+                word &= word - 1u;
+            }
+        }
+    }
+
+private:
+    static unsigned CountTrailingZeros(uint64_t word);
+
+    std::vector<uint64_t> bits;
+    size_t count = 0;
+};
@@ -0,0 +1,43 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+FrameArena::~FrameArena()
+{
+    for (const Block &block : blocks)
+    {
+        ::operator delete(block.data, std::align_val_t{alignof(std::max_align_t)});
+    }
+}
+
+void FrameArena::Reset()
+{
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+    for (; current < blocks.size(); ++current, offset = 0)
+    {
+        const Block &block = blocks[current];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+        const size_t start = static_cast<size_t>(((base + offset + alignment - 1u) & ~(uintptr_t{alignment} - 1u)) - base);
+        if (start + bytes <= block.size)
+        {
+            offset = start + bytes;
+            used += bytes;
+            return block.data + start;
+        }
+    }
+    // Out of blocks: grow by one big enough for this request. Later frames
+    // reuse it, so this only happens while the arena warms up.
+    const size_t size = std::max(blockBytes, bytes + alignment);
+    blocks.push_back(Block{static_cast<unsigned char *>(::operator new(size, std::align_val_t{alignof(std::max_align_t)})), size});
+    current = blocks.size() - 1u;
+    offset = 0;
+    return do_allocate(bytes, alignment);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Linear allocator for data that lives at most one frame. Allocation bumps
+// a pointer and deallocation does nothing; Reset at frame end releases
+// everything at once. Blocks are kept across resets, so once the arena has
+// grown to a frame's peak it never touches the heap again. As a
+// pmr::memory_resource it backs std::pmr strings and containers directly.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    explicit FrameArena(size_t blockBytes = size_t{64} << 10) : blockBytes(blockBytes) {}
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+    ~FrameArena() override;
+
+    void Reset();
+    size_t Used() const { return used; } // bytes handed out since Reset
+
+private:
+    struct Block
+    {
+        unsigned char *data = nullptr;
+        size_t size = 0;
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    size_t blockBytes;
+    std::vector<Block> blocks;
+    size_t current = 0; // block being filled
+    size_t offset = 0;  // within blocks[current]
+    size_t used = 0;
+};
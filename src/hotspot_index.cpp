@@ -0,0 +1,122 @@
+#include "hotspot_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void BuildHotspotIndex(const std::vector<Hotspot> &hotspots, HotspotIndex &index)
+{
+    index = HotspotIndex{};
+    if (hotspots.empty())
+    {
+        index.cellStart.assign(1, 0u);
+        return;
+    }
+
+    float minX = hotspots[0].area.x;
+    float minY = hotspots[0].area.y;
+    float maxX = minX;
+    float maxY = minY;
+    for (const auto &h : hotspots)
+    {
+        minX = std::min(minX, h.area.x);
+        minY = std::min(minY, h.area.y);
+        maxX = std::max(maxX, h.area.x + h.area.width);
+        maxY = std::max(maxY, h.area.y + h.area.height);
+    }
+    index.bounds = Rectangle{minX, minY, maxX - minX, maxY - minY};
+    index.cols = std::max(1, static_cast<int>(std::ceil(index.bounds.width / index.cellSize)));
+    index.rows = std::max(1, static_cast<int>(std::ceil(index.bounds.height / index.cellSize)));
+
+    // Pick order once; every cell inherits it by inserting in this order.
+    std::vector<uint32_t> order(hotspots.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                     { return hotspots[a].z > hotspots[b].z; });
+
+    const size_t cellCount = static_cast<size_t>(index.cols) * static_cast<size_t>(index.rows);
+    std::vector<std::vector<uint32_t>> cells(cellCount);
+    for (const uint32_t i : order)
+    {
+        const Rectangle &r = hotspots[i].area;
+        const int c0 = std::clamp(static_cast<int>((r.x - minX) / index.cellSize), 0, index.cols - 1);
+        const int c1 = std::clamp(static_cast<int>((r.x + r.width - minX) / index.cellSize), 0, index.cols - 1);
+        const int r0 = std::clamp(static_cast<int>((r.y - minY) / index.cellSize), 0, index.rows - 1);
+        const int r1 = std::clamp(static_cast<int>((r.y + r.height - minY) / index.cellSize), 0, index.rows - 1);
+        for (int row = r0; row <= r1; ++row)
+        {
+            for (int col = c0; col <= c1; ++col)
+            {
+                cells[static_cast<size_t>(row * index.cols + col)].push_back(i);
+            }
+        }
+    }
+
+    index.cellStart.reserve(cellCount + 1);
+    for (const auto &cell : cells)
+    {
+        index.cellStart.push_back(static_cast<uint32_t>(index.cellHotspots.size()));
+        index.cellHotspots.insert(index.cellHotspots.end(), cell.begin(), cell.end());
+    }
+    index.cellStart.push_back(static_cast<uint32_t>(index.cellHotspots.size()));
+}
+
+bool HotspotContains(const Hotspot &hotspot, Vector2 p)
+{
+    const Rectangle &r = hotspot.area;
+    if (p.x < r.x || p.y < r.y || p.x >= r.x + r.width || p.y >= r.y + r.height)
+    {
+        return false;
+    }
+
+    const std::vector<Vector2> &poly = hotspot.outline;
+    if (!poly.empty())
+    {
+        bool inside = false;
+        for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++)
+        {
+            if ((poly[i].y > p.y) != (poly[j].y > p.y) &&
+                p.x < (poly[j].x - poly[i].x) * (p.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x)
+            {
+                inside = !inside;
+            }
+        }
+        if (!inside)
+        {
+            return false;
+        }
+    }
+
+    const HotspotMask &mask = hotspot.mask;
+    if (mask.width > 0 && mask.height > 0)
+    {
+        const int mx = std::min(mask.width - 1, static_cast<int>((p.x - r.x) / r.width * static_cast<float>(mask.width)));
+        const int my = std::min(mask.height - 1, static_cast<int>((p.y - r.y) / r.height * static_cast<float>(mask.height)));
+        const size_t bit = static_cast<size_t>(my) * static_cast<size_t>(mask.width) + static_cast<size_t>(mx);
+        if ((mask.bits[bit / 32u] & (1u << (bit % 32u))) == 0u)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int PickHotspot(const std::vector<Hotspot> &hotspots, const HotspotIndex &index, Vector2 p)
+{
+    const float fx = (p.x - index.bounds.x) / index.cellSize;
+    const float fy = (p.y - index.bounds.y) / index.cellSize;
+    if (index.cols == 0 || fx < 0.0f || fy < 0.0f || fx >= static_cast<float>(index.cols) || fy >= static_cast<float>(index.rows))
+    {
+        return -1;
+    }
+    const size_t cell = static_cast<size_t>(fy) * static_cast<size_t>(index.cols) + static_cast<size_t>(fx);
+    for (uint32_t k = index.cellStart[cell]; k < index.cellStart[cell + 1]; ++k)
+    {
+        const uint32_t i = index.cellHotspots[k];
+        if (HotspotContains(hotspots[i], p))
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 1-bit mask stretched over a hotspot's rectangle, row-major.
+struct HotspotMask
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> bits;
+};
+
+struct Hotspot
+{
+    Rectangle area{};
+    std::string label;
+    int dialogueNode = -1; // pack node index
+    std::string transitionTo;
+    Vector2 spawnPosition{};
+    int z = 0;
+    std::vector<Vector2> outline; // empty: the rectangle is the shape
+    HotspotMask mask;             // width 0: no mask
+};
+
+// Hotspots bucketed into a uniform grid over their combined bounds. Each
+// cell lists the hotspots overlapping it already in pick order (higher z
+// first, then authoring order), so a pick walks one short list and stops at
+// the first exact hit.
+struct HotspotIndex
+{
+    Rectangle bounds{};
+    float cellSize = 128.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> cellStart; // cols * rows + 1 offsets into cellHotspots
+    std::vector<uint32_t> cellHotspots;
+};
+
+void BuildHotspotIndex(const std::vector<Hotspot> &hotspots, HotspotIndex &index);
+
+// Exact shape test: rectangle, then outline, then mask.
+bool HotspotContains(const Hotspot &hotspot, Vector2 p);
+
+// Index of the topmost hotspot under p, or -1.
+int PickHotspot(const std::vector<Hotspot> &hotspots, const HotspotIndex &index, Vector2 p);
@@ -0,0 +1,155 @@
+#include "jobs.h"
+
+// Which deque the calling thread owns; 0 for threads that are not workers
+// of that system.
+struct WorkerSlot
+{
+    const JobSystem *owner = nullptr;
+    unsigned index = 0;
+};
+
+static thread_local WorkerSlot workerSlot;
+
+JobSystem &Jobs()
+{
+    static JobSystem jobs;
+    return jobs;
+}
+
+JobSystem::JobSystem()
+{
+    queues.push_back(std::make_unique<Queue>());
+}
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+void JobSystem::Start(unsigned workerCount)
+{
+    if (!workers.empty())
+    {
+        return;
+    }
+    stopping = false;
+    queues.resize(1);
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back([this, i]
+                             { Worker(i + 1u); });
+    }
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        const std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    // Anything still queued runs here so no counter is left hanging.
+    while (TryRun())
+    {
+    }
+}
+
+void JobSystem::Spawn(JobCounter &counter, JobFn fn, const void *context, size_t begin, size_t end)
+{
+    counter.pending.fetch_add(1u, std::memory_order_relaxed);
+    const unsigned index = workerSlot.owner == this ? workerSlot.index : 0u;
+    Queue &queue = *queues[index];
+    // Counted before the push so a thief can never take the job first and
+    // wrap the count. Pairs with the sleeping/queued check in Worker: either
+    // the worker sees this job before it sleeps or we see it asleep.
+    queued.fetch_add(1u);
+    {
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job{fn, context, begin, end, &counter});
+    }
+    if (sleeping.load() > 0u)
+    {
+        const std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::TryRun()
+{
+    const unsigned self = workerSlot.owner == this ? workerSlot.index : 0u;
+    const size_t count = queues.size();
+    Job job;
+    bool found = false;
+    for (size_t k = 0; k < count && !found; ++k)
+    {
+        const size_t victim = (self + k) % count;
+        Queue &queue = *queues[victim];
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+        {
+            continue;
+        }
+        // Own deque from the back (newest), others from the front (oldest).
+        if (k == 0)
+        {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        else
+        {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        found = true;
+    }
+    if (!found)
+    {
+        return false;
+    }
+    queued.fetch_sub(1u, std::memory_order_relaxed);
+    job.fn(job.context, job.begin, job.end);
+    job.counter->pending.fetch_sub(1u, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::Wait(JobCounter &counter)
+{
+    while (!counter.Done())
+    {
+        if (!TryRun())
+        {
+            // The rest is running on other cores; nothing left to help with.
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::Worker(unsigned index)
+{
+    workerSlot = WorkerSlot{this, index};
+    for (;;)
+    {
+        if (TryRun())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1u);
+        wake.wait(lock, [this]
+                  { return stopping || queued.load() > 0u; });
+        sleeping.fetch_sub(1u);
+        if (stopping && queued.load() == 0u)
+        {
+            return;
+        }
+    }
+}
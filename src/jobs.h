@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts unfinished jobs. A job spawned from inside another job can share
+// its parent's counter, so waiting on the root waits for the whole tree.
+class JobCounter
+{
+public:
+    bool Done() const { return pending.load(std::memory_order_acquire) == 0u; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending{0};
+};
+
+// Work-stealing scheduler for short CPU work. Every worker owns a deque: it
+// pushes and pops its own jobs at the back, so a fork-join tree runs depth
+// first and stays in cache, while idle workers steal from the front of the
+// others, taking the oldest and usually largest piece. Threads that are not
+// workers (window, sim) share one extra deque. Wait never blocks while work
+// is queued; the waiting thread runs jobs until its counter drains. With no
+// workers started, every job simply runs inside Wait.
+//
+// Blocking I/O (asset decode, save writes) keeps its own threads; a job that
+// waits on disk would hold a core the frame needs.
+class JobSystem
+{
+public:
+    using JobFn = void (*)(const void *context, size_t begin, size_t end);
+
+    JobSystem();
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    ~JobSystem();
+
+    void Start(unsigned workerCount);
+    void Shutdown(); // finishes queued jobs first
+    unsigned WorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Queues fn(context, begin, end). The context must outlive the Wait on
+    // counter; nothing is copied.
+    void Spawn(JobCounter &counter, JobFn fn, const void *context, size_t begin = 0, size_t end = 0);
+
+    template <typename Fn>
+    void Spawn(JobCounter &counter, const Fn &fn) // fn()
+    {
+        Spawn(counter, [](const void *context, size_t, size_t)
+              { (*static_cast<const Fn *>(context))(); }, &fn);
+    }
+
+    void Wait(JobCounter &counter);
+
+    // Calls fn(begin, end) over [0, count) in pieces of at most grain items.
+    // The range is halved recursively and one half left for thieves, so an
+    // idle core picks up work in O(log n) steals. Small counts run inline.
+    template <typename Fn>
+    void ParallelFor(size_t count, size_t grain, const Fn &fn)
+    {
+        grain = std::max<size_t>(grain, 1u);
+        if (count <= grain || workers.empty())
+        {
+            fn(size_t{0}, count);
+            return;
+        }
+        struct Range
+        {
+            JobSystem *jobs;
+            const Fn *fn;
+            size_t grain;
+            JobCounter *counter;
+
+            static void Run(const void *context, size_t begin, size_t end)
+            {
+                const Range &range = *static_cast<const Range *>(context);
+                while (end - begin > range.grain)
+                {
+                    const size_t mid = begin + (end - begin) / 2u;
+                    range.jobs->Spawn(*range.counter, &Range::Run, context, mid, end);
+                    end = mid;
+                }
+                (*range.fn)(begin, end);
+            }
+        };
+        JobCounter counter;
+        const Range range{this, &fn, grain, &counter};
+        Range::Run(&range, 0, count);
+        Wait(counter);
+    }
+
+private:
+    struct Job
+    {
+        JobFn fn = nullptr;
+        const void *context = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        JobCounter *counter = nullptr;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    bool TryRun();
+    void Worker(unsigned index);
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] is shared by non-worker threads
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> queued{0};
+    std::atomic<uint32_t> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Process-wide scheduler the game subsystems share.
+JobSystem &Jobs();
@@ -0,0 +1,754 @@
+#include "navmesh.h"
+
+#include "raymath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <numeric>
+
+static float Cross(Vector2 a, Vector2 b, Vector2 c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+static bool SamePoint(Vector2 a, Vector2 b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+static float SignedArea(const std::vector<Vector2> &poly)
+{
+    float area = 0.0f;
+    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++)
+    {
+        area += poly[j].x * poly[i].y - poly[i].x * poly[j].y;
+    }
+    return area * 0.5f;
+}
+
+static bool PointInTriangle(Vector2 p, Vector2 a, Vector2 b, Vector2 c)
+{
+    return Cross(a, b, p) >= 0.0f && Cross(b, c, p) >= 0.0f && Cross(c, a, p) >= 0.0f;
+}
+
+static bool PointInRing(Vector2 p, const std::vector<Vector2> &ring)
+{
+    bool inside = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    {
+        const Vector2 a = ring[i];
+        const Vector2 b = ring[j];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+static bool SegmentsCross(Vector2 a, Vector2 b, Vector2 c, Vector2 d)
+{
+    const float d1 = Cross(c, d, a);
+    const float d2 = Cross(c, d, b);
+    const float d3 = Cross(a, b, c);
+    const float d4 = Cross(a, b, d);
+    return ((d1 > 0.0f && d2 < 0.0f) || (d1 < 0.0f && d2 > 0.0f)) &&
+           ((d3 > 0.0f && d4 < 0.0f) || (d3 < 0.0f && d4 > 0.0f));
+}
+
+static bool RingBlocksSegment(const std::vector<Vector2> &ring, Vector2 a, Vector2 b)
+{
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    {
+        const Vector2 c = ring[j];
+        const Vector2 d = ring[i];
+        if (SamePoint(c, a) || SamePoint(c, b) || SamePoint(d, a) || SamePoint(d, b))
+        {
+            continue;
+        }
+        if (SegmentsCross(a, b, c, d))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Splices each hole into the outline through a bridge to the nearest visible
+// outline vertex, yielding one weakly simple ring that ear clipping accepts.
+// A hole with no clear bridge (overlapping the outline or another hole) is
+// an authoring error; leaving it out would make the obstacle walkable.
+static bool MergeHoles(
+    const std::vector<Vector2> &outline,
+    std::vector<std::vector<Vector2>> holes,
+    std::vector<Vector2> &merged,
+    std::string &error)
+{
+    merged = outline;
+    if (SignedArea(merged) < 0.0f)
+    {
+        std::reverse(merged.begin(), merged.end());
+    }
+
+    holes.erase(std::remove_if(holes.begin(), holes.end(), [](const std::vector<Vector2> &h)
+                               { return h.size() < 3; }),
+                holes.end());
+    for (auto &hole : holes)
+    {
+        if (SignedArea(hole) > 0.0f)
+        {
+            std::reverse(hole.begin(), hole.end());
+        }
+    }
+
+    const auto maxX = [](const std::vector<Vector2> &ring)
+    {
+        return std::max_element(ring.begin(), ring.end(), [](Vector2 a, Vector2 b)
+                                { return a.x < b.x; });
+    };
+    std::sort(holes.begin(), holes.end(), [&](const std::vector<Vector2> &a, const std::vector<Vector2> &b)
+              { return maxX(a)->x > maxX(b)->x; });
+
+    for (size_t h = 0; h < holes.size(); ++h)
+    {
+        const std::vector<Vector2> &hole = holes[h];
+        const size_t m = static_cast<size_t>(maxX(hole) - hole.begin());
+        const Vector2 bridgeFrom = hole[m];
+
+        std::vector<size_t> order(merged.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                  { return Vector2DistanceSqr(merged[a], bridgeFrom) < Vector2DistanceSqr(merged[b], bridgeFrom); });
+
+        size_t bridgeTo = merged.size();
+        for (const size_t candidate : order)
+        {
+            const Vector2 to = merged[candidate];
+            if (RingBlocksSegment(merged, bridgeFrom, to))
+            {
+                continue;
+            }
+            bool blocked = false;
+            for (size_t other = h; other < holes.size() && !blocked; ++other)
+            {
+                blocked = RingBlocksSegment(holes[other], bridgeFrom, to);
+            }
+            const Vector2 mid = Vector2Lerp(bridgeFrom, to, 0.5f);
+            if (blocked || !PointInRing(mid, outline) || PointInRing(mid, hole))
+            {
+                continue;
+            }
+            bridgeTo = candidate;
+            break;
+        }
+        if (bridgeTo == merged.size())
+        {
+            char where[64];
+            std::snprintf(where, sizeof(where), "(%.0f, %.0f)", bridgeFrom.x, bridgeFrom.y);
+            error = std::string("walk hole at ") + where + " cannot be bridged to the outline; does it overlap the outline or another hole?";
+            return false;
+        }
+
+        std::vector<Vector2> spliced;
+        spliced.reserve(merged.size() + hole.size() + 2);
+        spliced.insert(spliced.end(), merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(bridgeTo) + 1);
+        for (size_t k = 0; k <= hole.size(); ++k)
+        {
+            spliced.push_back(hole[(m + k) % hole.size()]);
+        }
+        spliced.insert(spliced.end(), merged.begin() + static_cast<std::ptrdiff_t>(bridgeTo), merged.end());
+        merged = std::move(spliced);
+    }
+
+    return true;
+}
+
+static void EarClip(const std::vector<Vector2> &ring, std::vector<int> &outTriangles)
+{
+    std::vector<int> remaining(ring.size());
+    std::iota(remaining.begin(), remaining.end(), 0);
+
+    while (remaining.size() > 3)
+    {
+        const size_t n = remaining.size();
+        bool clipped = false;
+        for (size_t i = 0; i < n && !clipped; ++i)
+        {
+            const int ia = remaining[(i + n - 1) % n];
+            const int ib = remaining[i];
+            const int ic = remaining[(i + 1) % n];
+            const Vector2 a = ring[static_cast<size_t>(ia)];
+            const Vector2 b = ring[static_cast<size_t>(ib)];
+            const Vector2 c = ring[static_cast<size_t>(ic)];
+            if (Cross(a, b, c) <= 0.0f)
+            {
+                continue;
+            }
+
+            bool ear = true;
+            for (const int k : remaining)
+            {
+                const Vector2 p = ring[static_cast<size_t>(k)];
+                if (k == ia || k == ib || k == ic || SamePoint(p, a) || SamePoint(p, b) || SamePoint(p, c))
+                {
+                    continue;
+                }
+                if (PointInTriangle(p, a, b, c))
+                {
+                    ear = false;
+                    break;
+                }
+            }
+            if (!ear)
+            {
+                continue;
+            }
+
+            outTriangles.insert(outTriangles.end(), {ia, ib, ic});
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i));
+            clipped = true;
+        }
+
+        if (!clipped)
+        {
+            // Degenerate remainder (collinear bridge spur): drop the flattest
+            // vertex and keep going instead of giving up on the whole mesh.
+            size_t flattest = 0;
+            float best = INFINITY;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float area = std::fabs(Cross(
+                    ring[static_cast<size_t>(remaining[(i + n - 1) % n])],
+                    ring[static_cast<size_t>(remaining[i])],
+                    ring[static_cast<size_t>(remaining[(i + 1) % n])]));
+                if (area < best)
+                {
+                    best = area;
+                    flattest = i;
+                }
+            }
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(flattest));
+        }
+    }
+
+    if (remaining.size() == 3 &&
+        Cross(ring[static_cast<size_t>(remaining[0])], ring[static_cast<size_t>(remaining[1])], ring[static_cast<size_t>(remaining[2])]) > 0.0f)
+    {
+        outTriangles.insert(outTriangles.end(), remaining.begin(), remaining.end());
+    }
+}
+
+static int GridX(const NavMesh &mesh, float x)
+{
+    return std::clamp(static_cast<int>((x - mesh.gridBounds.x) / mesh.cellSize), 0, mesh.cols - 1);
+}
+
+static int GridY(const NavMesh &mesh, float y)
+{
+    return std::clamp(static_cast<int>((y - mesh.gridBounds.y) / mesh.cellSize), 0, mesh.rows - 1);
+}
+
+static void BuildTriangleGrid(NavMesh &mesh)
+{
+    float minX = INFINITY;
+    float minY = INFINITY;
+    float maxX = -INFINITY;
+    float maxY = -INFINITY;
+    for (const Vector2 v : mesh.vertices)
+    {
+        minX = std::min(minX, v.x);
+        minY = std::min(minY, v.y);
+        maxX = std::max(maxX, v.x);
+        maxY = std::max(maxY, v.y);
+    }
+    mesh.gridBounds = Rectangle{minX, minY, std::max(maxX - minX, 1.0f), std::max(maxY - minY, 1.0f)};
+
+    // About one triangle per cell, with the same cap as the walk area grid.
+    const float targetCells = std::clamp(static_cast<float>(mesh.triangles.size()), 1.0f, 4096.0f);
+    mesh.cellSize = std::max(std::sqrt(mesh.gridBounds.width * mesh.gridBounds.height / targetCells), 8.0f);
+    mesh.cols = std::max(1, static_cast<int>(std::ceil(mesh.gridBounds.width / mesh.cellSize)));
+    mesh.rows = std::max(1, static_cast<int>(std::ceil(mesh.gridBounds.height / mesh.cellSize)));
+
+    const size_t cellCount = static_cast<size_t>(mesh.cols) * static_cast<size_t>(mesh.rows);
+    std::vector<uint32_t> counts(cellCount, 0u);
+    const auto forEachCell = [&](const NavTriangle &tri, auto &&visit)
+    {
+        const Vector2 a = mesh.vertices[static_cast<size_t>(tri.v[0])];
+        const Vector2 b = mesh.vertices[static_cast<size_t>(tri.v[1])];
+        const Vector2 c = mesh.vertices[static_cast<size_t>(tri.v[2])];
+        const int cx0 = GridX(mesh, std::min({a.x, b.x, c.x}));
+        const int cx1 = GridX(mesh, std::max({a.x, b.x, c.x}));
+        const int cy0 = GridY(mesh, std::min({a.y, b.y, c.y}));
+        const int cy1 = GridY(mesh, std::max({a.y, b.y, c.y}));
+        for (int cy = cy0; cy <= cy1; ++cy)
+        {
+            for (int cx = cx0; cx <= cx1; ++cx)
+            {
+                visit(static_cast<size_t>(cy) * static_cast<size_t>(mesh.cols) + static_cast<size_t>(cx));
+            }
+        }
+    };
+
+    for (const NavTriangle &tri : mesh.triangles)
+    {
+        forEachCell(tri, [&](size_t cell)
+                    { ++counts[cell]; });
+    }
+    mesh.cellStart.assign(cellCount + 1, 0u);
+    for (size_t c = 0; c < cellCount; ++c)
+    {
+        mesh.cellStart[c + 1] = mesh.cellStart[c] + counts[c];
+    }
+    mesh.cellTriangles.resize(mesh.cellStart[cellCount]);
+    std::fill(counts.begin(), counts.end(), 0u);
+    for (size_t t = 0; t < mesh.triangles.size(); ++t)
+    {
+        forEachCell(mesh.triangles[t], [&](size_t cell)
+                    { mesh.cellTriangles[mesh.cellStart[cell] + counts[cell]++] = static_cast<uint32_t>(t); });
+    }
+}
+
+bool BuildNavMesh(
+    const std::vector<Vector2> &outline,
+    const std::vector<std::vector<Vector2>> &holes,
+    NavMesh &mesh,
+    std::string &error)
+{
+    mesh = NavMesh{};
+    if (outline.size() < 3)
+    {
+        error = "walk outline needs at least 3 points";
+        return false;
+    }
+    BuildWalkArea(outline, holes, mesh.area);
+
+    std::vector<Vector2> ring;
+    if (!MergeHoles(outline, holes, ring, error))
+    {
+        return false;
+    }
+    std::vector<int> ringTriangles;
+    EarClip(ring, ringTriangles);
+    if (ringTriangles.empty())
+    {
+        error = "walk outline does not triangulate";
+        return false;
+    }
+
+    // Bridges duplicate vertices; weld them so adjacency sees shared edges.
+    std::map<std::pair<float, float>, int> welded;
+    std::vector<int> remap(ring.size());
+    for (size_t i = 0; i < ring.size(); ++i)
+    {
+        const auto key = std::make_pair(ring[i].x, ring[i].y);
+        const auto it = welded.find(key);
+        if (it != welded.end())
+        {
+            remap[i] = it->second;
+            continue;
+        }
+        const int id = static_cast<int>(mesh.vertices.size());
+        welded.emplace(key, id);
+        mesh.vertices.push_back(ring[i]);
+        remap[i] = id;
+    }
+
+    std::map<std::pair<int, int>, std::pair<int, int>> openEdges;
+    for (size_t t = 0; t + 2 < ringTriangles.size(); t += 3)
+    {
+        NavTriangle tri;
+        for (int k = 0; k < 3; ++k)
+        {
+            tri.v[k] = remap[static_cast<size_t>(ringTriangles[t + static_cast<size_t>(k)])];
+        }
+        const Vector2 a = mesh.vertices[static_cast<size_t>(tri.v[0])];
+        const Vector2 b = mesh.vertices[static_cast<size_t>(tri.v[1])];
+        const Vector2 c = mesh.vertices[static_cast<size_t>(tri.v[2])];
+        tri.centroid = Vector2{(a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f};
+
+        const int triIndex = static_cast<int>(mesh.triangles.size());
+        mesh.triangles.push_back(tri);
+        for (int e = 0; e < 3; ++e)
+        {
+            const int u = tri.v[e];
+            const int w = tri.v[(e + 1) % 3];
+            const auto key = std::make_pair(std::min(u, w), std::max(u, w));
+            const auto it = openEdges.find(key);
+            if (it == openEdges.end())
+            {
+                openEdges.emplace(key, std::make_pair(triIndex, e));
+                continue;
+            }
+            mesh.triangles[static_cast<size_t>(triIndex)].neighbor[e] = it->second.first;
+            mesh.triangles[static_cast<size_t>(it->second.first)].neighbor[it->second.second] = triIndex;
+            openEdges.erase(it);
+        }
+    }
+
+    BuildTriangleGrid(mesh);
+    return true;
+}
+
+int FindNavTriangle(const NavMesh &mesh, Vector2 p)
+{
+    const Rectangle &bounds = mesh.gridBounds;
+    if (mesh.cellStart.empty() || p.x < bounds.x || p.y < bounds.y ||
+        p.x > bounds.x + bounds.width || p.y > bounds.y + bounds.height)
+    {
+        return -1;
+    }
+    const size_t cell = static_cast<size_t>(GridY(mesh, p.y)) * static_cast<size_t>(mesh.cols) + static_cast<size_t>(GridX(mesh, p.x));
+    for (uint32_t k = mesh.cellStart[cell]; k < mesh.cellStart[cell + 1]; ++k)
+    {
+        const NavTriangle &tri = mesh.triangles[mesh.cellTriangles[k]];
+        if (PointInTriangle(
+                p,
+                mesh.vertices[static_cast<size_t>(tri.v[0])],
+                mesh.vertices[static_cast<size_t>(tri.v[1])],
+                mesh.vertices[static_cast<size_t>(tri.v[2])]))
+        {
+            return static_cast<int>(mesh.cellTriangles[k]);
+        }
+    }
+    return -1;
+}
+
+static Vector2 ClosestPointOnTriangle(Vector2 p, Vector2 a, Vector2 b, Vector2 c)
+{
+    const Vector2 ab = Vector2Subtract(b, a);
+    const Vector2 ac = Vector2Subtract(c, a);
+    const Vector2 ap = Vector2Subtract(p, a);
+    const float d1 = Vector2DotProduct(ab, ap);
+    const float d2 = Vector2DotProduct(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+    {
+        return a;
+    }
+
+    const Vector2 bp = Vector2Subtract(p, b);
+    const float d3 = Vector2DotProduct(ab, bp);
+    const float d4 = Vector2DotProduct(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+    {
+        return b;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    {
+        return Vector2Add(a, Vector2Scale(ab, d1 / (d1 - d3)));
+    }
+
+    const Vector2 cp = Vector2Subtract(p, c);
+    const float d5 = Vector2DotProduct(ab, cp);
+    const float d6 = Vector2DotProduct(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+    {
+        return c;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    {
+        return Vector2Add(a, Vector2Scale(ac, d2 / (d2 - d6)));
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    {
+        return Vector2Add(b, Vector2Scale(Vector2Subtract(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    }
+
+    const float denom = 1.0f / (va + vb + vc);
+    return Vector2Add(a, Vector2Add(Vector2Scale(ab, vb * denom), Vector2Scale(ac, vc * denom)));
+}
+
+Vector2 ClosestNavPoint(const NavMesh &mesh, Vector2 p, int *outTriangle)
+{
+    Vector2 best = p;
+    int bestTri = FindNavTriangle(mesh, p);
+    if (bestTri < 0 && !mesh.cellStart.empty())
+    {
+        // Ring search outward from the cell under p, as ClosestBoundaryPoint
+        // does for walk edges: stop once the unvisited rings are farther away
+        // than the best point found.
+        const float minX = mesh.gridBounds.x;
+        const float minY = mesh.gridBounds.y;
+        const Vector2 q{
+            std::clamp(p.x, minX, minX + mesh.gridBounds.width),
+            std::clamp(p.y, minY, minY + mesh.gridBounds.height)};
+        const int cx = GridX(mesh, q.x);
+        const int cy = GridY(mesh, q.y);
+
+        float bestDist = INFINITY;
+        const int maxRing = std::max(mesh.cols, mesh.rows);
+        for (int ring = 0; ring <= maxRing; ++ring)
+        {
+            if (ring > 0)
+            {
+                const float innerMinX = minX + static_cast<float>(cx - ring + 1) * mesh.cellSize;
+                const float innerMinY = minY + static_cast<float>(cy - ring + 1) * mesh.cellSize;
+                const float innerMaxX = minX + static_cast<float>(cx + ring) * mesh.cellSize;
+                const float innerMaxY = minY + static_cast<float>(cy + ring) * mesh.cellSize;
+                const float reach = std::min({q.x - innerMinX, innerMaxX - q.x, q.y - innerMinY, innerMaxY - q.y});
+                if (reach > 0.0f && reach * reach >= bestDist)
+                {
+                    break;
+                }
+            }
+
+            for (int y = cy - ring; y <= cy + ring; ++y)
+            {
+                if (y < 0 || y >= mesh.rows)
+                {
+                    continue;
+                }
+                const bool edgeRow = (y == cy - ring || y == cy + ring);
+                const int step = edgeRow ? 1 : std::max(2 * ring, 1);
+                for (int x = cx - ring; x <= cx + ring; x += step)
+                {
+                    if (x < 0 || x >= mesh.cols)
+                    {
+                        continue;
+                    }
+                    const size_t cell = static_cast<size_t>(y) * static_cast<size_t>(mesh.cols) + static_cast<size_t>(x);
+                    for (uint32_t k = mesh.cellStart[cell]; k < mesh.cellStart[cell + 1]; ++k)
+                    {
+                        const NavTriangle &tri = mesh.triangles[mesh.cellTriangles[k]];
+                        const Vector2 candidate = ClosestPointOnTriangle(
+                            p,
+                            mesh.vertices[static_cast<size_t>(tri.v[0])],
+                            mesh.vertices[static_cast<size_t>(tri.v[1])],
+                            mesh.vertices[static_cast<size_t>(tri.v[2])]);
+                        const float dist = Vector2DistanceSqr(p, candidate);
+                        if (dist < bestDist)
+                        {
+                            bestDist = dist;
+                            best = candidate;
+                            bestTri = static_cast<int>(mesh.cellTriangles[k]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (outTriangle != nullptr)
+    {
+        *outTriangle = bestTri;
+    }
+    return best;
+}
+
+static Vector2 EdgeMidpoint(const NavMesh &mesh, const NavTriangle &tri, int edge)
+{
+    return Vector2Lerp(
+        mesh.vertices[static_cast<size_t>(tri.v[edge])],
+        mesh.vertices[static_cast<size_t>(tri.v[(edge + 1) % 3])],
+        0.5f);
+}
+
+static bool SearchCorridor(const NavMesh &mesh, NavQuery &query, int startTri, int goalTri, Vector2 start, Vector2 goal)
+{
+    const size_t count = mesh.triangles.size();
+    if (query.visitStamp.size() != count)
+    {
+        query.cost.assign(count, 0.0f);
+        query.parent.assign(count, -1);
+        query.entry.assign(count, Vector2{});
+        query.visitStamp.assign(count, 0u);
+        query.closedStamp.assign(count, 0u);
+        query.stamp = 0;
+    }
+    ++query.stamp;
+
+    const auto byScore = std::greater<std::pair<float, int>>();
+    query.open.clear();
+    query.cost[static_cast<size_t>(startTri)] = 0.0f;
+    query.parent[static_cast<size_t>(startTri)] = -1;
+    query.entry[static_cast<size_t>(startTri)] = start;
+    query.visitStamp[static_cast<size_t>(startTri)] = query.stamp;
+    query.open.emplace_back(Vector2Distance(start, goal), startTri);
+
+    while (!query.open.empty())
+    {
+        std::pop_heap(query.open.begin(), query.open.end(), byScore);
+        const int current = query.open.back().second;
+        query.open.pop_back();
+        const size_t cur = static_cast<size_t>(current);
+        if (query.closedStamp[cur] == query.stamp)
+        {
+            continue;
+        }
+        query.closedStamp[cur] = query.stamp;
+        if (current == goalTri)
+        {
+            break;
+        }
+
+        const NavTriangle &tri = mesh.triangles[cur];
+        for (int e = 0; e < 3; ++e)
+        {
+            const int next = tri.neighbor[e];
+            if (next < 0 || query.closedStamp[static_cast<size_t>(next)] == query.stamp)
+            {
+                continue;
+            }
+            const size_t nx = static_cast<size_t>(next);
+            const Vector2 portal = (next == goalTri) ? goal : EdgeMidpoint(mesh, tri, e);
+            const float cost = query.cost[cur] + Vector2Distance(query.entry[cur], portal);
+            if (query.visitStamp[nx] == query.stamp && cost >= query.cost[nx])
+            {
+                continue;
+            }
+            query.visitStamp[nx] = query.stamp;
+            query.cost[nx] = cost;
+            query.parent[nx] = current;
+            query.entry[nx] = portal;
+            query.open.emplace_back(cost + Vector2Distance(portal, goal), next);
+            std::push_heap(query.open.begin(), query.open.end(), byScore);
+        }
+    }
+
+    if (query.closedStamp[static_cast<size_t>(goalTri)] != query.stamp)
+    {
+        return false;
+    }
+
+    query.corridor.clear();
+    for (int at = goalTri; at >= 0; at = query.parent[static_cast<size_t>(at)])
+    {
+        query.corridor.push_back(at);
+    }
+    std::reverse(query.corridor.begin(), query.corridor.end());
+    return true;
+}
+
+// Simple stupid funnel over the triangle corridor portals. Portals are
+// oriented so that Cross(apex, right, left) > 0 while walking forward.
+static void StringPull(const NavQuery &query, std::vector<Vector2> &outPath)
+{
+    const std::vector<Vector2> &lefts = query.portalLeft;
+    const std::vector<Vector2> &rights = query.portalRight;
+    const size_t count = lefts.size();
+
+    Vector2 apex = lefts[0];
+    Vector2 left = lefts[0];
+    Vector2 right = rights[0];
+    size_t apexIndex = 0;
+    size_t leftIndex = 0;
+    size_t rightIndex = 0;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        const Vector2 l = lefts[i];
+        const Vector2 r = rights[i];
+
+        if (Cross(apex, right, r) >= 0.0f)
+        {
+            if (SamePoint(apex, right) || Cross(apex, left, r) < 0.0f)
+            {
+                right = r;
+                rightIndex = i;
+            }
+            else
+            {
+                outPath.push_back(left);
+                apex = left;
+                apexIndex = leftIndex;
+                right = apex;
+                rightIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+
+        if (Cross(apex, left, l) <= 0.0f)
+        {
+            if (SamePoint(apex, left) || Cross(apex, right, l) > 0.0f)
+            {
+                left = l;
+                leftIndex = i;
+            }
+            else
+            {
+                outPath.push_back(right);
+                apex = right;
+                apexIndex = rightIndex;
+                left = apex;
+                leftIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+    }
+
+    const Vector2 goal = lefts[count - 1];
+    if (outPath.empty() || !SamePoint(outPath.back(), goal))
+    {
+        outPath.push_back(goal);
+    }
+}
+
+bool FindNavPath(const NavMesh &mesh, NavQuery &query, Vector2 start, Vector2 goal, std::vector<Vector2> &outPath)
+{
+    outPath.clear();
+    if (mesh.triangles.empty())
+    {
+        return false;
+    }
+
+    int startTri = FindNavTriangle(mesh, start);
+    if (startTri < 0)
+    {
+        start = ClosestNavPoint(mesh, start, &startTri);
+    }
+    int goalTri = FindNavTriangle(mesh, goal);
+    if (goalTri < 0)
+    {
+        goal = ClampToWalkable(mesh.area, goal);
+        goalTri = FindNavTriangle(mesh, goal);
+    }
+    if (goalTri < 0)
+    {
+        goal = ClosestNavPoint(mesh, goal, &goalTri);
+    }
+
+    if (startTri == goalTri)
+    {
+        outPath.push_back(goal);
+        return true;
+    }
+    if (!SearchCorridor(mesh, query, startTri, goalTri, start, goal))
+    {
+        return false;
+    }
+
+    query.portalLeft.clear();
+    query.portalRight.clear();
+    query.portalLeft.push_back(start);
+    query.portalRight.push_back(start);
+    for (size_t i = 0; i + 1 < query.corridor.size(); ++i)
+    {
+        const NavTriangle &tri = mesh.triangles[static_cast<size_t>(query.corridor[i])];
+        const int next = query.corridor[i + 1];
+        for (int e = 0; e < 3; ++e)
+        {
+            if (tri.neighbor[e] != next)
+            {
+                continue;
+            }
+            query.portalRight.push_back(mesh.vertices[static_cast<size_t>(tri.v[e])]);
+            query.portalLeft.push_back(mesh.vertices[static_cast<size_t>(tri.v[(e + 1) % 3])]);
+            break;
+        }
+    }
+    query.portalLeft.push_back(goal);
+    query.portalRight.push_back(goal);
+
+    StringPull(query, outPath);
+    return true;
+}
+
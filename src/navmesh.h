@@ -0,0 +1,62 @@
+#pragma once
+
+#include "raylib.h"
+#include "walk_area.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct NavTriangle
+{
+    int v[3] = {-1, -1, -1};
+    int neighbor[3] = {-1, -1, -1}; // across edge v[i] -> v[(i + 1) % 3]
+    Vector2 centroid{};
+};
+
+struct NavMesh
+{
+    std::vector<Vector2> vertices;
+    std::vector<NavTriangle> triangles;
+    WalkArea area;
+
+    // Triangles bucketed by bounding box into a uniform grid, CSR like the
+    // walk area, so point location and nearest-point queries only test the
+    // triangles around the query point.
+    Rectangle gridBounds{};
+    float cellSize = 1.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> cellStart; // cols * rows + 1 offsets into cellTriangles
+    std::vector<uint32_t> cellTriangles;
+};
+
+// Scratch state reused between path queries so a click does not allocate.
+struct NavQuery
+{
+    std::vector<float> cost;
+    std::vector<int> parent;
+    std::vector<Vector2> entry;
+    std::vector<uint32_t> visitStamp;
+    std::vector<uint32_t> closedStamp;
+    std::vector<std::pair<float, int>> open;
+    std::vector<int> corridor;
+    std::vector<Vector2> portalLeft;
+    std::vector<Vector2> portalRight;
+    uint32_t stamp = 0;
+};
+
+// Fails with a reason when the outline is degenerate or a hole cannot be
+// spliced into it.
+bool BuildNavMesh(
+    const std::vector<Vector2> &outline,
+    const std::vector<std::vector<Vector2>> &holes,
+    NavMesh &mesh,
+    std::string &error);
+
+int FindNavTriangle(const NavMesh &mesh, Vector2 p);
+Vector2 ClosestNavPoint(const NavMesh &mesh, Vector2 p, int *outTriangle = nullptr);
+
+// Fills outPath with waypoints after `start`, ending at the (clamped) goal.
+bool FindNavPath(const NavMesh &mesh, NavQuery &query, Vector2 start, Vector2 goal, std::vector<Vector2> &outPath);
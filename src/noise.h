@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+inline uint32_t HashNoise(int x, int y, int frame)
+{
+    uint32_t h = static_cast<uint32_t>(x) * 374761393u;
+    h += static_cast<uint32_t>(y) * 668265263u;
+    h += static_cast<uint32_t>(frame) * 2246822519u;
+    h = (h ^ (h >> 13u)) * 1274126177u;
+    return h ^ (h >> 16u);
+}
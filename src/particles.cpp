@@ -0,0 +1,207 @@
+#include "particles.h"
+
+#include "jobs.h"
+
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Quads handed to rlgl per batch-limit check; well under its default buffer.
+static constexpr size_t kParticleChunk = 1024;
+static constexpr size_t kParticleJobGrain = 16384; // below this a job costs more than it saves
+
+std::vector<ParticleEmitter> BuildEmitters(const ContentPack &content, const PackScene &scene)
+{
+    std::vector<ParticleEmitter> out;
+    for (const auto &record : content.Emitters(scene))
+    {
+        if (record.budget == 0 || record.size <= 0.0f || record.life[0] <= 0.0f)
+        {
+            continue;
+        }
+        ParticleEmitter emitter;
+        emitter.budget = record.budget;
+        emitter.color = Color{record.color[0], record.color[1], record.color[2], record.color[3]};
+        emitter.size = record.size;
+        std::copy(record.areaFrac, record.areaFrac + 4, emitter.areaFrac);
+        std::copy(record.areaPx, record.areaPx + 4, emitter.areaPx);
+        emitter.drift = Vector2{record.drift[0], record.drift[1]};
+        emitter.jitter = Vector2{record.jitter[0], record.jitter[1]};
+        emitter.lifeMin = record.life[0];
+        emitter.lifeMax = std::max(record.life[0], record.life[1]);
+        emitter.seed = record.seed;
+        out.push_back(emitter);
+    }
+    return out;
+}
+
+bool ParticleField::LoadSprite(int size)
+{
+    UnloadSprite();
+    if (size <= 0)
+    {
+        return false;
+    }
+    // Soft round mote with a quadratic falloff, white so vertex color tints it.
+    std::vector<Color> pixels(static_cast<size_t>(size) * static_cast<size_t>(size));
+    const float radius = static_cast<float>(size) * 0.5f;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            const float dx = (static_cast<float>(x) + 0.5f - radius) / radius;
+            const float dy = (static_cast<float>(y) + 0.5f - radius) / radius;
+            const float falloff = std::max(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+            pixels[static_cast<size_t>(y * size + x)] = Color{255, 255, 255, static_cast<unsigned char>(falloff * falloff * 255.0f)};
+        }
+    }
+    Image image{};
+    image.data = pixels.data();
+    image.width = size;
+    image.height = size;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    sprite = LoadTextureFromImage(image);
+    return sprite.id != 0;
+}
+
+void ParticleField::UnloadSprite()
+{
+    if (sprite.id != 0)
+    {
+        UnloadTexture(sprite);
+    }
+    sprite = Texture2D{};
+}
+
+void ParticleField::Reset(const std::vector<ParticleEmitter> &sceneEmitters, Vector2 extent)
+{
+    emitters = sceneEmitters;
+    slices.clear();
+    size_t total = 0;
+    rng = XorShift32{};
+    for (const auto &emitter : emitters)
+    {
+        Slice slice;
+        slice.first = total;
+        slice.count = emitter.budget;
+        slice.area = Rectangle{
+            emitter.areaFrac[0] * extent.x + emitter.areaPx[0],
+            emitter.areaFrac[1] * extent.y + emitter.areaPx[1],
+            emitter.areaFrac[2] * extent.x + emitter.areaPx[2],
+            emitter.areaFrac[3] * extent.y + emitter.areaPx[3]};
+        slices.push_back(slice);
+        total += emitter.budget;
+        rng.state ^= emitter.seed;
+    }
+    if (rng.state == 0u)
+    {
+        rng.state = 1u;
+    }
+
+    posX.assign(total, 0.0f);
+    posY.assign(total, 0.0f);
+    velX.assign(total, 0.0f);
+    velY.assign(total, 0.0f);
+    age.assign(total, 0.0f);
+    ageRate.assign(total, 0.0f);
+    for (size_t e = 0; e < slices.size(); ++e)
+    {
+        for (size_t i = slices[e].first; i < slices[e].first + slices[e].count; ++i)
+        {
+            Spawn(e, i);
+            // Stagger ages so a fresh scene does not pulse as one generation.
+            age[i] = rng.Unit();
+        }
+    }
+}
+
+void ParticleField::Spawn(size_t emitter, size_t i)
+{
+    const ParticleEmitter &e = emitters[emitter];
+    const Rectangle &area = slices[emitter].area;
+    posX[i] = area.x + rng.Unit() * area.width;
+    posY[i] = area.y + rng.Unit() * area.height;
+    velX[i] = e.drift.x + (rng.Unit() * 2.0f - 1.0f) * e.jitter.x;
+    velY[i] = e.drift.y + (rng.Unit() * 2.0f - 1.0f) * e.jitter.y;
+    age[i] = 0.0f;
+    ageRate[i] = 1.0f / (e.lifeMin + rng.Unit() * (e.lifeMax - e.lifeMin));
+}
+
+// value += rate * dt over one array pair. Kept to a single stream each so
+// the alias check is trivial and the loop vectorizes at -O2/-O3.
+static void Integrate(float *value, const float *rate, size_t n, float dt)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        value[i] += rate[i] * dt;
+    }
+}
+
+void ParticleField::Update(float dt)
+{
+    // Integration is independent per particle, so large fields split across
+    // cores; respawns stay serial because they share the random stream.
+    Jobs().ParallelFor(posX.size(), kParticleJobGrain, [&](size_t begin, size_t end)
+                       {
+        Integrate(posX.data() + begin, velX.data() + begin, end - begin, dt);
+        Integrate(posY.data() + begin, velY.data() + begin, end - begin, dt);
+        Integrate(age.data() + begin, ageRate.data() + begin, end - begin, dt); });
+
+    const float *a = age.data();
+
+    for (size_t e = 0; e < slices.size(); ++e)
+    {
+        const size_t end = slices[e].first + slices[e].count;
+        for (size_t i = slices[e].first; i < end; ++i)
+        {
+            if (a[i] >= 1.0f)
+            {
+                Spawn(e, i);
+            }
+        }
+    }
+}
+
+void ParticleField::Draw() const
+{
+    if (posX.empty())
+    {
+        return;
+    }
+    const unsigned int texture = sprite.id != 0 ? sprite.id : rlGetTextureIdDefault();
+    for (size_t e = 0; e < slices.size(); ++e)
+    {
+        const Color color = emitters[e].color;
+        const float half = emitters[e].size * 0.5f;
+        const size_t end = slices[e].first + slices[e].count;
+        for (size_t chunk = slices[e].first; chunk < end; chunk += kParticleChunk)
+        {
+            const size_t chunkEnd = std::min(end, chunk + kParticleChunk);
+            rlCheckRenderBatchLimit(static_cast<int>(chunkEnd - chunk) * 4);
+            rlSetTexture(texture);
+            rlBegin(RL_QUADS);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+            for (size_t i = chunk; i < chunkEnd; ++i)
+            {
+                // Fade in and out over the life so respawns never pop.
+                const float u = age[i];
+                const float fade = 4.0f * u * (1.0f - u);
+                rlColor4ub(color.r, color.g, color.b, static_cast<unsigned char>(static_cast<float>(color.a) * fade));
+                const float x = posX[i];
+                const float y = posY[i];
+                rlTexCoord2f(0.0f, 0.0f);
+                rlVertex2f(x - half, y - half);
+                rlTexCoord2f(0.0f, 1.0f);
+                rlVertex2f(x - half, y + half);
+                rlTexCoord2f(1.0f, 1.0f);
+                rlVertex2f(x + half, y + half);
+                rlTexCoord2f(1.0f, 0.0f);
+                rlVertex2f(x + half, y - half);
+            }
+            rlEnd();
+        }
+    }
+    rlSetTexture(0);
+}
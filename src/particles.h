@@ -0,0 +1,71 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "content_pack.h"
+#include "xorshift.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Emitter settings resolved from the pack. The spawn area stays relative to
+// the world extent until a field is reset for the scene.
+struct ParticleEmitter
+{
+    uint32_t budget = 0;
+    Color color{};
+    float size = 2.0f;
+    float areaFrac[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    float areaPx[4] = {};
+    Vector2 drift{};
+    Vector2 jitter{};
+    float lifeMin = 4.0f;
+    float lifeMax = 8.0f;
+    uint32_t seed = 0;
+};
+
+std::vector<ParticleEmitter> BuildEmitters(const ContentPack &content, const PackScene &scene);
+
+// Drifting motes stored as structure-of-arrays. Each emitter owns a fixed,
+// contiguous slice of its budget: nothing allocates after Reset and a dead
+// particle is respawned in place. The integrate step is one branch-free loop
+// over plain float arrays so the compiler vectorizes it; Draw emits a
+// textured quad per particle into the shared rlgl batch.
+class ParticleField
+{
+public:
+    ParticleField() = default;
+    ParticleField(const ParticleField &) = delete;
+    ParticleField &operator=(const ParticleField &) = delete;
+
+    bool LoadSprite(int size = 16);
+    void UnloadSprite();
+
+    void Reset(const std::vector<ParticleEmitter> &sceneEmitters, Vector2 extent);
+    void Update(float dt);
+    void Draw() const;
+
+    size_t Count() const { return posX.size(); }
+
+private:
+    struct Slice
+    {
+        size_t first = 0;
+        size_t count = 0;
+        Rectangle area{};
+    };
+
+    void Spawn(size_t emitter, size_t i);
+
+    std::vector<ParticleEmitter> emitters;
+    std::vector<Slice> slices;
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> age; // 0..1 over the particle's life
+    std::vector<float> ageRate;
+    Texture2D sprite{};
+    XorShift32 rng; // visual only, never feeds the sim hash
+};
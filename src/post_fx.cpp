@@ -0,0 +1,219 @@
+#include "post_fx.h"
+
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// GLSL 330 keeps this on the desktop GL path raylib already uses, which
+// Mesa's llvmpipe runs without a GPU. Uses raylib's default vertex shader.
+static const char *const kPostFxFragment = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform sampler2D gradeLut;
+uniform vec2 resolution;
+uniform vec2 time; // seconds, frame
+uniform float grain;
+uniform float scanlines;
+uniform float vignette;
+uniform float aberration;
+
+const float kLutSize = 16.0;
+
+vec3 Grade(vec3 c)
+{
+    // 16^3 cube unwrapped along x: blue picks the slice, red/green the texel.
+    float b = clamp(c.b, 0.0, 1.0) * (kLutSize - 1.0);
+    float b0 = floor(b);
+    float b1 = min(b0 + 1.0, kLutSize - 1.0);
+    vec2 uv = vec2((clamp(c.r, 0.0, 1.0) * (kLutSize - 1.0) + 0.5) / (kLutSize * kLutSize),
+                   (clamp(c.g, 0.0, 1.0) * (kLutSize - 1.0) + 0.5) / kLutSize);
+    vec3 s0 = texture(gradeLut, uv + vec2(b0 / kLutSize, 0.0)).rgb;
+    vec3 s1 = texture(gradeLut, uv + vec2(b1 / kLutSize, 0.0)).rgb;
+    return mix(s0, s1, b - b0);
+}
+
+float Hash(vec2 p)
+{
+    p = fract(p * vec2(443.897, 441.423));
+    p += dot(p, p.yx + 19.19);
+    return fract((p.x + p.y) * p.x);
+}
+
+void main()
+{
+    vec2 uv = fragTexCoord;
+    vec2 fromCenter = uv - 0.5;
+    vec2 shift = fromCenter * 2.0 * aberration / resolution;
+    vec3 c;
+    c.r = texture(texture0, uv + shift).r;
+    c.g = texture(texture0, uv).g;
+    c.b = texture(texture0, uv - shift).b;
+
+    c = Grade(c);
+
+    float edge = length(fromCenter * vec2(1.0, 0.82)) * 1.6;
+    float pulse = 1.0 + sin(time.x * 1.2) * 0.12;
+    c *= 1.0 - vignette * pulse * smoothstep(0.35, 1.0, edge);
+
+    if (mod(floor(gl_FragCoord.y), 4.0) < 1.0)
+    {
+        c *= 1.0 - scanlines;
+    }
+
+    c += (Hash(gl_FragCoord.xy + mod(time.y, 97.0) * 13.7) - 0.5) * grain;
+    finalColor = vec4(c, 1.0) * fragColor;
+}
+)";
+
+PostFxSettings PostFxFromPack(const PackPostFx &record)
+{
+    PostFxSettings settings;
+    settings.grain = record.grain;
+    settings.scanlines = record.scanlines;
+    settings.vignette = record.vignette;
+    settings.aberration = record.aberration;
+    settings.saturation = record.saturation;
+    settings.contrast = record.contrast;
+    settings.shadowTint = Color{record.shadowTint[0], record.shadowTint[1], record.shadowTint[2], record.shadowTint[3]};
+    settings.highlightTint = Color{record.highlightTint[0], record.highlightTint[1], record.highlightTint[2], record.highlightTint[3]};
+    return settings;
+}
+
+bool LoadPostFx(PostFx &fx, int width, int height)
+{
+    UnloadPostFx(fx);
+    fx.shader = LoadShaderFromMemory(nullptr, kPostFxFragment);
+    if (fx.shader.id == 0 || fx.shader.id == rlGetShaderIdDefault())
+    {
+        // raylib hands back its default shader when compilation fails.
+        fx.shader = Shader{};
+        return false;
+    }
+    fx.target = LoadRenderTexture(width, height);
+    std::vector<Color> identity(static_cast<size_t>(kGradeLutSize * kGradeLutSize * kGradeLutSize), WHITE);
+    Image image{};
+    image.data = identity.data();
+    image.width = kGradeLutSize * kGradeLutSize;
+    image.height = kGradeLutSize;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    fx.lut = LoadTextureFromImage(image);
+    if (fx.target.id == 0 || fx.lut.id == 0)
+    {
+        UnloadPostFx(fx);
+        return false;
+    }
+    SetTextureFilter(fx.target.texture, TEXTURE_FILTER_BILINEAR);
+    SetTextureWrap(fx.target.texture, TEXTURE_WRAP_CLAMP);
+    SetTextureFilter(fx.lut, TEXTURE_FILTER_BILINEAR);
+    SetTextureWrap(fx.lut, TEXTURE_WRAP_CLAMP);
+
+    fx.resolutionLoc = GetShaderLocation(fx.shader, "resolution");
+    fx.timeLoc = GetShaderLocation(fx.shader, "time");
+    fx.grainLoc = GetShaderLocation(fx.shader, "grain");
+    fx.scanlinesLoc = GetShaderLocation(fx.shader, "scanlines");
+    fx.vignetteLoc = GetShaderLocation(fx.shader, "vignette");
+    fx.aberrationLoc = GetShaderLocation(fx.shader, "aberration");
+    fx.lutLoc = GetShaderLocation(fx.shader, "gradeLut");
+    const float resolution[2] = {static_cast<float>(width), static_cast<float>(height)};
+    SetShaderValue(fx.shader, fx.resolutionLoc, resolution, SHADER_UNIFORM_VEC2);
+    fx.ready = true;
+    SetPostFxGrade(fx, PostFxSettings{});
+    return true;
+}
+
+void UnloadPostFx(PostFx &fx)
+{
+    if (fx.target.id != 0)
+    {
+        UnloadRenderTexture(fx.target);
+    }
+    if (fx.lut.id != 0)
+    {
+        UnloadTexture(fx.lut);
+    }
+    if (fx.shader.id != 0)
+    {
+        UnloadShader(fx.shader);
+    }
+    fx = PostFx{};
+}
+
+static float Mix(float a, float b, float k)
+{
+    return a + (b - a) * k;
+}
+
+void SetPostFxGrade(PostFx &fx, const PostFxSettings &settings)
+{
+    if (!fx.ready)
+    {
+        return;
+    }
+    const int n = kGradeLutSize;
+    const float shadow[3] = {settings.shadowTint.r / 255.0f, settings.shadowTint.g / 255.0f, settings.shadowTint.b / 255.0f};
+    const float highlight[3] = {settings.highlightTint.r / 255.0f, settings.highlightTint.g / 255.0f, settings.highlightTint.b / 255.0f};
+    const float shadowMix = settings.shadowTint.a / 255.0f;
+    const float highlightMix = settings.highlightTint.a / 255.0f;
+
+    std::vector<Color> pixels(static_cast<size_t>(n * n * n));
+    for (int b = 0; b < n; ++b)
+    {
+        for (int g = 0; g < n; ++g)
+        {
+            for (int r = 0; r < n; ++r)
+            {
+                float c[3] = {
+                    static_cast<float>(r) / static_cast<float>(n - 1),
+                    static_cast<float>(g) / static_cast<float>(n - 1),
+                    static_cast<float>(b) / static_cast<float>(n - 1)};
+                const float luma = 0.299f * c[0] + 0.587f * c[1] + 0.114f * c[2];
+                const float shadowWeight = (1.0f - luma) * (1.0f - luma) * shadowMix;
+                const float highlightWeight = luma * luma * highlightMix;
+                unsigned char out[3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    float v = Mix(luma, c[k], settings.saturation);
+                    v = (v - 0.5f) * settings.contrast + 0.5f;
+                    v = Mix(v, shadow[k], shadowWeight);
+                    v = Mix(v, highlight[k], highlightWeight);
+                    out[k] = static_cast<unsigned char>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                pixels[static_cast<size_t>(g * n * n + b * n + r)] = Color{out[0], out[1], out[2], 255};
+            }
+        }
+    }
+    UpdateTexture(fx.lut, pixels.data());
+}
+
+void BeginPostFx(PostFx &fx)
+{
+    BeginTextureMode(fx.target);
+}
+
+void EndPostFx(PostFx &)
+{
+    EndTextureMode();
+}
+
+void DrawPostFx(const PostFx &fx, const PostFxSettings &settings, float t, int frame)
+{
+    const float time[2] = {t, static_cast<float>(frame)};
+    SetShaderValue(fx.shader, fx.timeLoc, time, SHADER_UNIFORM_VEC2);
+    SetShaderValue(fx.shader, fx.grainLoc, &settings.grain, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(fx.shader, fx.scanlinesLoc, &settings.scanlines, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(fx.shader, fx.vignetteLoc, &settings.vignette, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(fx.shader, fx.aberrationLoc, &settings.aberration, SHADER_UNIFORM_FLOAT);
+
+    BeginShaderMode(fx.shader);
+    SetShaderValueTexture(fx.shader, fx.lutLoc, fx.lut);
+    // Render textures are stored bottom-up; flip the source.
+    const Rectangle source{0.0f, 0.0f, static_cast<float>(fx.target.texture.width), -static_cast<float>(fx.target.texture.height)};
+    DrawTextureRec(fx.target.texture, source, Vector2{0.0f, 0.0f}, WHITE);
+    EndShaderMode();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "content_pack.h"
+
+constexpr int kGradeLutSize = 16; // LUT cube edge; stored as a 256x16 strip
+
+struct PostFxSettings
+{
+    float grain = 0.06f;
+    float scanlines = 0.08f;
+    float vignette = 0.5f;
+    float aberration = 1.0f;
+    float saturation = 1.0f;
+    float contrast = 1.0f;
+    Color shadowTint{0, 0, 0, 0};
+    Color highlightTint{255, 255, 255, 0};
+};
+
+PostFxSettings PostFxFromPack(const PackPostFx &record);
+
+// Full-screen post stack. The world is drawn into `target`, then one
+// fragment pass applies chromatic offset, LUT grading, vignette, scanlines
+// and grain while copying it to the backbuffer. `ready` is false when the
+// shader or targets could not be created; callers then keep the CPU
+// atmosphere path.
+struct PostFx
+{
+    RenderTexture2D target{};
+    Shader shader{};
+    Texture2D lut{};
+    int resolutionLoc = -1;
+    int timeLoc = -1;
+    int grainLoc = -1;
+    int scanlinesLoc = -1;
+    int vignetteLoc = -1;
+    int aberrationLoc = -1;
+    int lutLoc = -1;
+    bool ready = false;
+};
+
+bool LoadPostFx(PostFx &fx, int width, int height);
+void UnloadPostFx(PostFx &fx);
+
+// Rebakes the grading LUT; call when the scene changes.
+void SetPostFxGrade(PostFx &fx, const PostFxSettings &settings);
+
+void BeginPostFx(PostFx &fx);
+void EndPostFx(PostFx &fx);
+void DrawPostFx(const PostFx &fx, const PostFxSettings &settings, float t, int frame);
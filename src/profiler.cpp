@@ -0,0 +1,176 @@
+#include "profiler.h"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static const char *const kZoneNames[kProfileZoneCount] = {
+    "frame",
+    "sim",
+    "sim.ambient",
+    "sim.quests",
+    "sim.free_roam",
+    "sim.dialogue",
+    "sim.transition",
+    "draw.backdrop",
+    "draw.particles",
+    "draw.world",
+    "draw.foreground",
+    "draw.atmosphere",
+    "draw.hud",
+    "draw.chronicle",
+    "draw.dialogue",
+    "draw.codex",
+    "present"};
+
+static constexpr size_t kStatsInterval = 15;
+static constexpr size_t kTraceEventsPerFrame = 32;
+
+const char *ProfileZoneName(ProfileZone zone)
+{
+    const size_t i = static_cast<size_t>(zone);
+    return i < kProfileZoneCount ? kZoneNames[i] : "?";
+}
+
+static thread_local uint32_t profileLane = 1;
+
+Profiler &FrameProfiler()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void SetProfileLane(uint32_t lane)
+{
+    profileLane = lane;
+}
+
+void Profiler::SetEnabled(bool on)
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    enabled = on;
+    std::fill(std::begin(current), std::end(current), 0.0f);
+}
+
+void Profiler::Record(ProfileZone zone, Clock::time_point start, Clock::time_point end)
+{
+    const size_t i = static_cast<size_t>(zone);
+    const std::lock_guard<std::mutex> lock(mutex);
+    current[i] += std::chrono::duration<float, std::milli>(end - start).count();
+    if (captureFramesLeft > 0 && trace.size() < trace.capacity())
+    {
+        trace.push_back(TraceEvent{
+            zone,
+            profileLane,
+            std::chrono::duration_cast<std::chrono::microseconds>(start - epoch).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()});
+    }
+}
+
+void Profiler::EndFrame()
+{
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled)
+    {
+        return;
+    }
+    std::copy(std::begin(current), std::end(current), history[head]);
+    std::fill(std::begin(current), std::end(current), 0.0f);
+    head = (head + 1u) % kProfileHistory;
+    ++frames;
+    if (frames % kStatsInterval == 0)
+    {
+        RefreshStats();
+    }
+    if (captureFramesLeft > 0)
+    {
+        --captureFramesLeft;
+    }
+}
+
+void Profiler::RefreshStats()
+{
+    const size_t count = std::min(frames, kProfileHistory);
+    float samples[kProfileHistory];
+    for (size_t z = 0; z < kProfileZoneCount; ++z)
+    {
+        float sum = 0.0f;
+        for (size_t f = 0; f < count; ++f)
+        {
+            samples[f] = history[f][z];
+            sum += samples[f];
+        }
+        ProfileStats &s = stats[z];
+        if (count == 0)
+        {
+            s = ProfileStats{};
+            continue;
+        }
+        const size_t p99 = std::min(count - 1u, (count * 99u) / 100u);
+        std::nth_element(samples, samples + p99, samples + count);
+        s.p99Ms = samples[p99];
+        s.minMs = *std::min_element(samples, samples + count);
+        s.avgMs = sum / static_cast<float>(count);
+    }
+}
+
+void Profiler::StartCapture(size_t frameCount)
+{
+    // Reserve up front so capturing does not allocate inside timed scopes.
+    const std::lock_guard<std::mutex> lock(mutex);
+    trace.clear();
+    trace.reserve(frameCount * kTraceEventsPerFrame);
+    captureFramesLeft = frameCount;
+}
+
+bool Profiler::WriteChromeTrace(const std::string &path) const
+{
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fputs("{\"traceEvents\":[\n", file);
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+        const TraceEvent &e = trace[i];
+        std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}%s\n",
+                     ProfileZoneName(e.zone),
+                     static_cast<unsigned>(e.lane),
+                     static_cast<long long>(e.startUs),
+                     static_cast<long long>(e.durationUs),
+                     i + 1u < trace.size() ? "," : "");
+    }
+    std::fputs("],\"displayTimeUnit\":\"ms\"}\n", file);
+    return std::fclose(file) == 0;
+}
+
+void DrawProfilerOverlay(const Profiler &profiler, int x, int y)
+{
+    const int rowHeight = 16;
+    const int barWidth = 220;
+    const float budgetMs = 1000.0f / 60.0f;
+    const int height = 26 + static_cast<int>(kProfileZoneCount) * rowHeight;
+    DrawRectangle(x, y, 520, height, Color{6, 8, 12, 214});
+    DrawText(TextFormat("PROFILER  min / avg / p99 ms over %i frames  (bar = avg vs 16.7 ms)",
+                        static_cast<int>(std::min(profiler.FramesRecorded(), kProfileHistory))),
+             x + 8, y + 6, 12, Color{238, 198, 132, 255});
+
+    for (size_t z = 0; z < kProfileZoneCount; ++z)
+    {
+        const ProfileZone zone = static_cast<ProfileZone>(z);
+        const ProfileStats &s = profiler.Stats(zone);
+        const int rowY = y + 24 + static_cast<int>(z) * rowHeight;
+        const bool nested = zone >= ProfileZone::SimAmbient && zone <= ProfileZone::SimTransition;
+        DrawText(ProfileZoneName(zone), x + (nested ? 18 : 8), rowY, 12, Color{196, 210, 218, 240});
+
+        const float fill = std::min(s.avgMs / budgetMs, 1.0f);
+        const float peak = std::min(s.p99Ms / budgetMs, 1.0f);
+        const int barX = x + 128;
+        DrawRectangle(barX, rowY + 2, barWidth, rowHeight - 6, Color{28, 34, 42, 220});
+        DrawRectangle(barX, rowY + 2, static_cast<int>(fill * barWidth), rowHeight - 6, Color{96, 170, 150, 230});
+        DrawRectangle(barX + static_cast<int>(peak * barWidth) - 1, rowY, 2, rowHeight - 2, Color{232, 128, 96, 240});
+        DrawText(TextFormat("%5.2f %5.2f %5.2f", s.minMs, s.avgMs, s.p99Ms), barX + barWidth + 10, rowY, 12, Color{196, 210, 218, 240});
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class ProfileZone : uint8_t
+{
+    Frame,
+    Sim,
+    SimAmbient,
+    SimQuests,
+    SimFreeRoam,
+    SimDialogue,
+    SimTransition,
+    Backdrop,
+    Particles,
+    WorldLayer,
+    Foreground,
+    Atmosphere,
+    Hud,
+    Chronicle,
+    Dialogue,
+    Codex,
+    Present,
+    Count
+};
+
+constexpr size_t kProfileZoneCount = static_cast<size_t>(ProfileZone::Count);
+constexpr size_t kProfileHistory = 240;
+
+const char *ProfileZoneName(ProfileZone zone);
+
+struct ProfileStats
+{
+    float minMs = 0.0f;
+    float avgMs = 0.0f;
+    float p99Ms = 0.0f;
+};
+
+// Frame profiler. Zone times are summed per frame into a fixed ring of the
+// last kProfileHistory frames; while a capture is running every scope is
+// also kept as a trace event for Chrome's about://tracing. Scopes may close
+// on the sim thread as well as the render thread; each thread shows up as
+// its own trace lane (see SetProfileLane).
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool on);
+
+    void Record(ProfileZone zone, Clock::time_point start, Clock::time_point end);
+    void EndFrame();
+
+    // Stats are refreshed every few frames, not on every call.
+    const ProfileStats &Stats(ProfileZone zone) const { return stats[static_cast<size_t>(zone)]; }
+    size_t FramesRecorded() const { return frames; }
+
+    void StartCapture(size_t frameCount);
+    bool Capturing() const { return captureFramesLeft > 0; }
+    bool WriteChromeTrace(const std::string &path) const;
+    bool CaptureReady() const { return captureFramesLeft == 0 && !trace.empty(); }
+    void ClearCapture() { trace.clear(); }
+
+private:
+    struct TraceEvent
+    {
+        ProfileZone zone;
+        uint32_t lane;
+        int64_t startUs;
+        int64_t durationUs;
+    };
+
+    void RefreshStats();
+
+    std::mutex mutex; // Record can arrive from the sim thread mid-frame
+    std::atomic<bool> enabled{false};
+    float current[kProfileZoneCount] = {};
+    float history[kProfileHistory][kProfileZoneCount] = {};
+    size_t head = 0;
+    size_t frames = 0;
+    ProfileStats stats[kProfileZoneCount];
+
+    Clock::time_point epoch = Clock::now();
+    std::vector<TraceEvent> trace;
+    size_t captureFramesLeft = 0;
+};
+
+Profiler &FrameProfiler();
+
+// Trace lane for scopes recorded on the calling thread; 1 unless set.
+void SetProfileLane(uint32_t lane);
+
+// Times the enclosing block. When the profiler is off the cost is one
+// branch; define WORLDFORGE_NO_PROFILER to compile scopes out entirely.
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileZone scopeZone) : zone(scopeZone), active(FrameProfiler().Enabled())
+    {
+        if (active)
+        {
+            start = Profiler::Clock::now();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (active)
+        {
+            FrameProfiler().Record(zone, start, Profiler::Clock::now());
+        }
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    ProfileZone zone;
+    bool active;
+    Profiler::Clock::time_point start{};
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#if defined(WORLDFORGE_NO_PROFILER)
+#define PROFILE_ZONE(zone) ((void)0)
+#else
+#define PROFILE_ZONE(zone) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(zone)
+#endif
+
+// Bar overlay with min/avg/p99 per zone, drawn in screen space.
+void DrawProfilerOverlay(const Profiler &profiler, int x, int y);
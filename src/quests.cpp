@@ -0,0 +1,87 @@
+#include "quests.h"
+
+void QuestTracker::Build(const std::vector<Quest *> &order, size_t flagCount)
+{
+    quests = order;
+    subscribers.clear();
+    pendingFlags.clear();
+    pendingQuests.clear();
+
+    for (uint32_t q = 0; q < quests.size(); ++q)
+    {
+        quests[q]->trackerIndex = q;
+    }
+    scheduledStamp.assign(quests.size(), 0u);
+    stamp = 1;
+
+    std::vector<uint32_t> counts(flagCount + 1u, 0u);
+    const auto forEachSubscription = [&](auto &&visit)
+    {
+        for (uint32_t q = 0; q < quests.size(); ++q)
+        {
+            const auto &objectives = quests[q]->objectives;
+            for (uint32_t o = 0; o < objectives.size(); ++o)
+            {
+                for (const auto &word : objectives[o].doneMask.words)
+                {
+                    for (uint32_t bit = 0; bit < 64u; ++bit)
+                    {
+                        if (((word.second >> bit) & 1u) != 0u)
+                        {
+                            visit(static_cast<FlagId>(word.first * 64u + bit), Subscriber{q, o});
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    forEachSubscription([&](FlagId id, const Subscriber &)
+                        { ++counts[id]; });
+    subscriberStart.assign(flagCount + 1u, 0u);
+    for (size_t f = 0; f < flagCount; ++f)
+    {
+        subscriberStart[f + 1u] = subscriberStart[f] + counts[f];
+    }
+    subscribers.resize(subscriberStart[flagCount]);
+    std::fill(counts.begin(), counts.end(), 0u);
+    forEachSubscription([&](FlagId id, const Subscriber &sub)
+                        { subscribers[subscriberStart[id] + counts[id]++] = sub; });
+}
+
+void QuestTracker::NotifyFlag(FlagId id)
+{
+    ++revision;
+    if (id + 1u < subscriberStart.size() && subscriberStart[id] != subscriberStart[id + 1u])
+    {
+        pendingFlags.push_back(id);
+    }
+}
+
+void QuestTracker::Touch(const Quest &quest)
+{
+    ++revision;
+    if (quest.trackerIndex < quests.size() && quests[quest.trackerIndex] == &quest)
+    {
+        Schedule(quest.trackerIndex);
+    }
+}
+
+void QuestTracker::TouchAll()
+{
+    ++revision;
+    for (uint32_t q = 0; q < quests.size(); ++q)
+    {
+        Schedule(q);
+    }
+}
+
+void QuestTracker::Schedule(uint32_t quest)
+{
+    if (scheduledStamp[quest] == stamp)
+    {
+        return;
+    }
+    scheduledStamp[quest] = stamp;
+    pendingQuests.push_back(quest);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "flags.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class QuestState
+{
+    Locked,
+    Active,
+    Completed
+};
+
+struct QuestObjective
+{
+    std::string text;
+    FlagMask doneMask;
+};
+
+struct Quest
+{
+    std::string id;
+    std::string title;
+    std::string purpose;
+    QuestState state = QuestState::Locked;
+    size_t objectiveIndex = 0;
+    std::vector<QuestObjective> objectives;
+    uint32_t trackerIndex = 0; // position in QuestTracker::Build's order
+};
+
+// Inverted index from flag id to the objectives that complete on it. Flag
+// gains and quest starts only queue work; Flush hands each affected quest to
+// the caller once, so a frame without changes costs nothing. Quests are
+// numbered in the order given to Build (pack order), so when several change
+// in one frame they are handed over in the same order on every platform.
+class QuestTracker
+{
+public:
+    // Numbers the quests by their position in order (Quest::trackerIndex).
+    void Build(const std::vector<Quest *> &order, size_t flagCount);
+
+    void NotifyFlag(FlagId id);
+    // Touches share the flag gains' schedule, so a quest reaches progress at
+    // most once per Flush.
+    void Touch(const Quest &quest);
+    void TouchAll();
+    uint64_t Revision() const { return revision; } // bumps on every flag gain or quest touch
+
+    template <typename Fn>
+    void Flush(Fn &&progress)
+    {
+        for (size_t i = 0; i < pendingFlags.size(); ++i)
+        {
+            const FlagId id = pendingFlags[i];
+            for (uint32_t s = subscriberStart[id]; s < subscriberStart[id + 1u]; ++s)
+            {
+                const Subscriber &sub = subscribers[s];
+                const Quest &quest = *quests[sub.quest];
+                if (quest.state == QuestState::Active && quest.objectiveIndex == sub.objective)
+                {
+                    Schedule(sub.quest);
+                }
+            }
+        }
+        pendingFlags.clear();
+
+        // Progressing a quest can log and, in future, set flags; iterate by
+        // index so late additions are still drained this flush.
+        for (size_t i = 0; i < pendingQuests.size(); ++i)
+        {
+            progress(*quests[pendingQuests[i]]);
+        }
+        pendingQuests.clear();
+        ++stamp; // quests may be scheduled again from the next flush on
+    }
+
+private:
+    struct Subscriber
+    {
+        uint32_t quest = 0;
+        uint32_t objective = 0;
+    };
+
+    void Schedule(uint32_t questIndex);
+
+    std::vector<Quest *> quests;
+    std::vector<uint32_t> subscriberStart;
+    std::vector<Subscriber> subscribers;
+    std::vector<uint32_t> scheduledStamp;
+    std::vector<FlagId> pendingFlags;
+    std::vector<uint32_t> pendingQuests;
+    uint32_t stamp = 1; // scheduledStamp starts at 0, so nothing is scheduled yet
+    uint64_t revision = 0;
+};
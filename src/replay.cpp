@@ -0,0 +1,155 @@
+#include "replay.h"
+
+#include <limits>
+#include <sstream>
+
+static ReplayEvent &EventForFrame(Replay &replay, uint32_t frame)
+{
+    if (replay.events.empty() || replay.events.back().frame != frame)
+    {
+        replay.events.push_back(ReplayEvent{frame, SimInput{}});
+    }
+    return replay.events.back();
+}
+
+bool LoadReplay(const std::string &path, Replay &replay, std::string &error)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    replay = Replay{};
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+        bool ok = true;
+        if (key == "dt")
+        {
+            ok = static_cast<bool>(iss >> replay.dt) && replay.dt > 0.0f;
+        }
+        else if (key == "end")
+        {
+            ok = static_cast<bool>(iss >> replay.frameCount);
+        }
+        else if (key == "frame")
+        {
+            uint32_t frame = 0;
+            std::string action;
+            ok = static_cast<bool>(iss >> frame >> action);
+            if (ok && !replay.events.empty() && frame < replay.events.back().frame)
+            {
+                error = "line " + std::to_string(lineNumber) + ": frames out of order";
+                return false;
+            }
+            if (ok)
+            {
+                SimInput &input = EventForFrame(replay, frame).input;
+                if (action == "click")
+                {
+                    input.click = static_cast<bool>(iss >> input.clickWorld.x >> input.clickWorld.y);
+                    ok = input.click;
+                }
+                else if (action == "choice")
+                {
+                    ok = static_cast<bool>(iss >> input.choice);
+                }
+                else if (action == "save")
+                {
+                    input.save = true;
+                }
+                else if (action == "load")
+                {
+                    input.load = true;
+                }
+                else if (action == "rewind")
+                {
+                    input.rewind = true;
+                }
+                else
+                {
+                    ok = false;
+                }
+            }
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            error = "line " + std::to_string(lineNumber) + ": cannot parse '" + line + "'";
+            return false;
+        }
+    }
+
+    if (replay.frameCount == 0 && !replay.events.empty())
+    {
+        replay.frameCount = replay.events.back().frame + 1u;
+    }
+    return true;
+}
+
+bool ReplayRecorder::Open(const std::string &path, float dt)
+{
+    out.open(path, std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+    // Round-trip floats exactly so replays reproduce recorded clicks.
+    out.precision(std::numeric_limits<float>::max_digits10);
+    out << "# worldforge replay\n";
+    out << "dt " << dt << '\n';
+    return true;
+}
+
+void ReplayRecorder::Record(uint32_t frame, const SimInput &input)
+{
+    if (!out)
+    {
+        return;
+    }
+    if (input.click)
+    {
+        out << "frame " << frame << " click " << input.clickWorld.x << ' ' << input.clickWorld.y << '\n';
+    }
+    if (input.choice >= 0)
+    {
+        out << "frame " << frame << " choice " << input.choice << '\n';
+    }
+    if (input.save)
+    {
+        out << "frame " << frame << " save\n";
+    }
+    if (input.load)
+    {
+        out << "frame " << frame << " load\n";
+    }
+    if (input.rewind)
+    {
+        out << "frame " << frame << " rewind\n";
+    }
+}
+
+void ReplayRecorder::Close(uint32_t frameCount)
+{
+    if (out.is_open())
+    {
+        out << "end " << frameCount << '\n';
+        out.close();
+    }
+}
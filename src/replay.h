@@ -0,0 +1,43 @@
+#pragma once
+
+#include "sim.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Recorded input stream. Text format, one directive per line:
+//   dt <seconds>                 fixed step, default 1/60
+//   frame <n> click <x> <y>      world-space click
+//   frame <n> choice <index>     dialogue choice
+//   frame <n> save | load
+//   frame <n> rewind             back to before the last dialogue choice
+//   end <n>                      total frames to simulate
+// Frames without a directive run with empty input.
+struct ReplayEvent
+{
+    uint32_t frame = 0;
+    SimInput input;
+};
+
+struct Replay
+{
+    float dt = 1.0f / 60.0f;
+    uint32_t frameCount = 0;
+    std::vector<ReplayEvent> events; // sorted by frame, one per frame
+};
+
+bool LoadReplay(const std::string &path, Replay &replay, std::string &error);
+
+class ReplayRecorder
+{
+public:
+    bool Open(const std::string &path, float dt);
+    void Record(uint32_t frame, const SimInput &input);
+    void Close(uint32_t frameCount);
+    bool IsOpen() const { return out.is_open(); }
+
+private:
+    std::ofstream out;
+};
@@ -0,0 +1,507 @@
+#include "save_game.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct SaveHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t payloadSize;
+    uint32_t reserved;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(SaveHeader) == 24, "save header layout");
+
+static uint64_t SaveChecksum(const unsigned char *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+static void Put(std::vector<unsigned char> &out, T value)
+{
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+static void PutStr(std::vector<unsigned char> &out, std::string_view s)
+{
+    const uint16_t length = static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX));
+    Put(out, length);
+    out.insert(out.end(), s.data(), s.data() + length);
+}
+
+void EncodeSave(const SaveData &data, std::vector<unsigned char> &out)
+{
+    out.clear();
+    out.resize(sizeof(SaveHeader));
+    PutStr(out, data.sceneId);
+    Put(out, data.playerPos.x);
+    Put(out, data.playerPos.y);
+    Put(out, data.targetPos.x);
+    Put(out, data.targetPos.y);
+    Put(out, static_cast<int32_t>(data.composure));
+    Put(out, static_cast<int32_t>(data.crewTrust));
+    Put(out, static_cast<int32_t>(data.threat));
+    Put(out, static_cast<uint32_t>(data.flags.size()));
+    for (const std::string_view flag : data.flags)
+    {
+        PutStr(out, flag);
+    }
+    Put(out, static_cast<uint32_t>(data.quests.size()));
+    for (const SaveQuest &quest : data.quests)
+    {
+        PutStr(out, quest.id);
+        Put(out, static_cast<uint8_t>(quest.state));
+        Put(out, quest.objectiveIndex);
+    }
+    Put(out, data.contentFingerprint);
+    Put(out, data.historySize);
+    if (data.historySize > 0)
+    {
+        out.insert(out.end(), data.history, data.history + data.historySize);
+    }
+
+    SaveHeader header{};
+    std::memcpy(header.magic, kSaveMagic, sizeof(header.magic));
+    header.version = kSaveVersion;
+    header.payloadSize = static_cast<uint32_t>(out.size() - sizeof(SaveHeader));
+    header.checksum = SaveChecksum(out.data() + sizeof(SaveHeader), header.payloadSize);
+    std::memcpy(out.data(), &header, sizeof(header));
+}
+
+// Bounds-checked cursor over the payload; any short read latches failure.
+struct SaveReader
+{
+    const unsigned char *at;
+    const unsigned char *end;
+    bool ok = true;
+
+    template <typename T>
+    T Get()
+    {
+        T value{};
+        if (!ok || static_cast<size_t>(end - at) < sizeof(T))
+        {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    std::string_view GetStr()
+    {
+        const uint16_t length = Get<uint16_t>();
+        if (!ok || static_cast<size_t>(end - at) < length)
+        {
+            ok = false;
+            return {};
+        }
+        const std::string_view s(reinterpret_cast<const char *>(at), length);
+        at += length;
+        return s;
+    }
+};
+
+static bool DecodeBinary(const std::pmr::vector<unsigned char> &bytes, SaveData &data, std::string &error)
+{
+    SaveHeader header{};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.version == 0 || header.version > kSaveVersion)
+    {
+        error = "save version " + std::to_string(header.version) + " (expected " + std::to_string(kSaveVersion) + ")";
+        return false;
+    }
+    if (header.reserved != 0)
+    {
+        error = "save header reserved field set";
+        return false;
+    }
+    if (header.payloadSize != bytes.size() - sizeof(SaveHeader))
+    {
+        error = "save size mismatch";
+        return false;
+    }
+    const unsigned char *payload = bytes.data() + sizeof(SaveHeader);
+    if (SaveChecksum(payload, header.payloadSize) != header.checksum)
+    {
+        error = "save checksum mismatch";
+        return false;
+    }
+
+    SaveReader in{payload, payload + header.payloadSize};
+    data.skippedLines = 0;
+    data.sceneId = in.GetStr();
+    data.playerPos.x = in.Get<float>();
+    data.playerPos.y = in.Get<float>();
+    data.targetPos.x = in.Get<float>();
+    data.targetPos.y = in.Get<float>();
+    data.composure = in.Get<int32_t>();
+    data.crewTrust = in.Get<int32_t>();
+    data.threat = in.Get<int32_t>();
+
+    // Every name costs at least its length prefix, which caps the counts
+    // before anything is reserved.
+    const uint32_t flagCount = in.Get<uint32_t>();
+    if (flagCount > static_cast<size_t>(in.end - in.at) / sizeof(uint16_t))
+    {
+        in.ok = false;
+    }
+    data.flags.clear();
+    data.flags.reserve(in.ok ? flagCount : 0u);
+    for (uint32_t i = 0; in.ok && i < flagCount; ++i)
+    {
+        data.flags.push_back(in.GetStr());
+    }
+
+    const uint32_t questCount = in.Get<uint32_t>();
+    if (questCount > static_cast<size_t>(in.end - in.at) / (sizeof(uint16_t) + 5u))
+    {
+        in.ok = false;
+    }
+    data.quests.clear();
+    data.quests.reserve(in.ok ? questCount : 0u);
+    for (uint32_t i = 0; in.ok && i < questCount; ++i)
+    {
+        SaveQuest quest;
+        quest.id = in.GetStr();
+        const uint8_t state = in.Get<uint8_t>();
+        quest.objectiveIndex = in.Get<uint32_t>();
+        if (state > static_cast<uint8_t>(QuestState::Completed))
+        {
+            in.ok = false;
+        }
+        quest.state = static_cast<QuestState>(state);
+        data.quests.push_back(quest);
+    }
+
+    data.contentFingerprint = 0;
+    data.history = nullptr;
+    data.historySize = 0;
+    if (header.version >= 2)
+    {
+        data.contentFingerprint = in.Get<uint64_t>();
+        data.historySize = in.Get<uint32_t>();
+        if (!in.ok || static_cast<size_t>(in.end - in.at) < data.historySize)
+        {
+            in.ok = false;
+        }
+        else
+        {
+            data.history = in.at;
+            in.at += data.historySize;
+        }
+    }
+
+    if (!in.ok || in.at != in.end || data.sceneId.empty())
+    {
+        error = "save payload malformed";
+        return false;
+    }
+    return true;
+}
+
+static bool ParseQuestState(std::string_view token, QuestState &outState)
+{
+    if (token == "locked")
+    {
+        outState = QuestState::Locked;
+        return true;
+    }
+    if (token == "active")
+    {
+        outState = QuestState::Active;
+        return true;
+    }
+    if (token == "completed")
+    {
+        outState = QuestState::Completed;
+        return true;
+    }
+    return false;
+}
+
+static std::string_view NextToken(std::string_view &line)
+{
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos)
+    {
+        line = {};
+        return {};
+    }
+    line.remove_prefix(start);
+    const size_t end = std::min(line.find_first_of(" \t\r"), line.size());
+    const std::string_view token = line.substr(0, end);
+    line.remove_prefix(end);
+    return token;
+}
+
+template <typename T>
+static void ReadNumber(std::string_view &line, T &value)
+{
+    char buffer[32];
+    const std::string_view token = NextToken(line);
+    if (token.empty() || token.size() >= sizeof(buffer))
+    {
+        return;
+    }
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char *end = nullptr;
+    const double parsed = std::strtod(buffer, &end);
+    if (end != buffer)
+    {
+        value = static_cast<T>(parsed);
+    }
+}
+
+// The pre-binary format: one "key values..." record per line.
+static bool DecodeText(const std::pmr::vector<unsigned char> &bytes, SaveData &data, std::string &error)
+{
+    data = SaveData{};
+    std::string_view rest(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    while (!rest.empty())
+    {
+        const size_t newline = rest.find('\n');
+        std::string_view line = rest.substr(0, newline);
+        rest.remove_prefix(newline == std::string_view::npos ? rest.size() : newline + 1u);
+
+        const std::string_view key = NextToken(line);
+        if (key.empty())
+        {
+            continue;
+        }
+        if (key == "scene")
+        {
+            data.sceneId = NextToken(line);
+        }
+        else if (key == "player")
+        {
+            ReadNumber(line, data.playerPos.x);
+            ReadNumber(line, data.playerPos.y);
+        }
+        else if (key == "target")
+        {
+            ReadNumber(line, data.targetPos.x);
+            ReadNumber(line, data.targetPos.y);
+        }
+        else if (key == "stats")
+        {
+            ReadNumber(line, data.composure);
+            ReadNumber(line, data.crewTrust);
+            ReadNumber(line, data.threat);
+        }
+        else if (key == "flag")
+        {
+            const std::string_view flag = NextToken(line);
+            if (!flag.empty())
+            {
+                data.flags.push_back(flag);
+            }
+        }
+        else if (key == "quest")
+        {
+            SaveQuest quest;
+            quest.id = NextToken(line);
+            const std::string_view state = NextToken(line);
+            ReadNumber(line, quest.objectiveIndex);
+            if (!quest.id.empty() && ParseQuestState(state, quest.state))
+            {
+                data.quests.push_back(quest);
+            }
+        }
+        else
+        {
+            ++data.skippedLines;
+        }
+    }
+    if (data.sceneId.empty())
+    {
+        error = "save has no scene";
+        return false;
+    }
+    return true;
+}
+
+bool DecodeSave(const std::pmr::vector<unsigned char> &bytes, SaveData &data, std::string &error)
+{
+    if (bytes.size() >= sizeof(SaveHeader) && std::memcmp(bytes.data(), kSaveMagic, sizeof(kSaveMagic)) == 0)
+    {
+        return DecodeBinary(bytes, data, error);
+    }
+    return DecodeText(bytes, data, error);
+}
+
+bool ReadSaveFile(const std::string &path, std::pmr::vector<unsigned char> &bytes)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool ok = std::fseek(file, 0, SEEK_END) == 0;
+    const long size = ok ? std::ftell(file) : -1;
+    ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+    if (ok)
+    {
+        bytes.resize(static_cast<size_t>(size));
+        ok = bytes.empty() || std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+#if !defined(_WIN32)
+// The rename only survives a crash once the directory itself is synced.
+// Filesystems that cannot sync a directory report EINVAL; nothing more can
+// be done there.
+static bool SyncParentDirectory(const std::string &path)
+{
+    const size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? std::string(".") : path.substr(0, slash == 0 ? 1u : slash);
+    const int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    const bool ok = fsync(fd) == 0 || errno == EINVAL;
+    close(fd);
+    return ok;
+}
+#endif
+
+bool WriteSaveFile(const std::string &path, const std::vector<unsigned char> &bytes)
+{
+    const std::string temp = path + ".tmp";
+    std::FILE *file = std::fopen(temp.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool ok = bytes.empty() || std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = std::fflush(file) == 0 && ok;
+#if defined(_WIN32)
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    if (ok)
+    {
+#if defined(_WIN32)
+        ok = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        ok = std::rename(temp.c_str(), path.c_str()) == 0;
+        if (ok)
+        {
+            return SyncParentDirectory(path);
+        }
+#endif
+    }
+    if (!ok)
+    {
+        std::remove(temp.c_str());
+    }
+    return ok;
+}
+
+SaveWriter::~SaveWriter()
+{
+    Shutdown();
+}
+
+void SaveWriter::Submit(const std::string &path, std::vector<unsigned char> &bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+        {
+            return;
+        }
+        pendingPath = path;
+        pendingBytes.swap(bytes);
+        hasPending = true;
+        if (!worker.joinable())
+        {
+            worker = std::thread([this]()
+                                 { Run(); });
+        }
+    }
+    wake.notify_one();
+}
+
+void SaveWriter::Flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]()
+              { return !hasPending && !writing; });
+}
+
+void SaveWriter::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+void SaveWriter::Run()
+{
+    std::string path;
+    std::vector<unsigned char> bytes;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]()
+                      { return hasPending || stopping; });
+            if (!hasPending)
+            {
+                return;
+            }
+            path.swap(pendingPath);
+            bytes.swap(pendingBytes);
+            hasPending = false;
+            writing = true;
+        }
+        if (!WriteSaveFile(path, bytes))
+        {
+            failures.fetch_add(1u, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = false;
+        }
+        idle.notify_all();
+    }
+}
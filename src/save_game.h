@@ -0,0 +1,103 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "quests.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Binary command snapshot:
+//   header   magic "WFSV", version, payload bytes, reserved, FNV-1a 64 of the payload
+//   payload  scene, player xy, target xy, composure/crewTrust/threat,
+//            flag count + names, quest count + (id, state, objective index),
+//            content fingerprint + choice history blob (version 2)
+// Strings are u16 length + bytes; numbers are little-endian like the pack.
+// Flags and quests are stored by name so a save survives content rebuilds
+// that renumber ids.
+constexpr char kSaveMagic[4] = {'W', 'F', 'S', 'V'};
+constexpr uint32_t kSaveVersion = 2;
+
+struct SaveQuest
+{
+    std::string_view id;
+    QuestState state = QuestState::Locked;
+    uint32_t objectiveIndex = 0;
+};
+
+// Views point into the world when encoding and into the file bytes when
+// decoding, so neither direction copies names. The lists take their memory
+// from the given resource, normally the sim's frame arena.
+struct SaveData
+{
+    explicit SaveData(std::pmr::memory_resource *memory = std::pmr::get_default_resource()) : flags(memory), quests(memory) {}
+
+    std::string_view sceneId;
+    Vector2 playerPos{};
+    Vector2 targetPos{};
+    int composure = 0;
+    int crewTrust = 0;
+    int threat = 0;
+    std::pmr::vector<std::string_view> flags;
+    std::pmr::vector<SaveQuest> quests;
+    // SaveHistory bytes. They index flags, quests and nodes by id, so they
+    // only apply to a pack with the same fingerprint.
+    uint64_t contentFingerprint = 0;
+    const unsigned char *history = nullptr;
+    uint32_t historySize = 0;
+    uint32_t skippedLines = 0; // legacy text only: unknown keys
+};
+
+void EncodeSave(const SaveData &data, std::vector<unsigned char> &out);
+
+// Accepts the binary format and, for old saves, the line-based text format.
+// Returns false with a reason for truncated, corrupt or unknown data.
+bool DecodeSave(const std::pmr::vector<unsigned char> &bytes, SaveData &data, std::string &error);
+
+// One read of the whole file; false if it cannot be opened.
+bool ReadSaveFile(const std::string &path, std::pmr::vector<unsigned char> &bytes);
+
+// Writes path.tmp, flushes it to disk, renames it over path and flushes the
+// directory entry, so a crash leaves either the old save or the new one,
+// never a torn or vanished file.
+bool WriteSaveFile(const std::string &path, const std::vector<unsigned char> &bytes);
+
+// Writes saves on a worker thread, the only thread that touches save files.
+// Submit hands the bytes over and returns at once. Submits that arrive while
+// the worker is busy coalesce to the newest, and writes land in submit
+// order, so an older snapshot never lands over a newer one.
+class SaveWriter
+{
+public:
+    SaveWriter() = default;
+    SaveWriter(const SaveWriter &) = delete;
+    SaveWriter &operator=(const SaveWriter &) = delete;
+    ~SaveWriter();
+
+    // Takes the bytes by swap; the caller gets a spare buffer back to reuse.
+    void Submit(const std::string &path, std::vector<unsigned char> &bytes);
+    uint32_t TakeFailures() { return failures.exchange(0u, std::memory_order_relaxed); }
+    void Flush();    // blocks until every submitted snapshot is on disk
+    void Shutdown(); // writes anything still queued
+
+private:
+    void Run();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::thread worker;
+    bool stopping = false;
+    bool hasPending = false;
+    bool writing = false;
+    std::string pendingPath;
+    std::vector<unsigned char> pendingBytes;
+    std::atomic<uint32_t> failures{0};
+};
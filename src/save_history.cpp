@@ -0,0 +1,416 @@
+#include "save_history.h"
+
+#include <algorithm>
+#include <cstring>
+
+static void PutVar(std::vector<unsigned char> &out, uint64_t value)
+{
+    while (value >= 0x80u)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80u));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static void PutZig(std::vector<unsigned char> &out, int64_t value)
+{
+    PutVar(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+template <typename T>
+static void PutRaw(std::vector<unsigned char> &out, T value)
+{
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+// Bounds-checked cursor; any overrun latches failure.
+struct HistoryReader
+{
+    const unsigned char *at;
+    const unsigned char *end;
+    bool ok = true;
+
+    uint64_t Var()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64u; shift += 7u)
+        {
+            if (at == end)
+            {
+                break;
+            }
+            const unsigned char byte = *at++;
+            value |= static_cast<uint64_t>(byte & 0x7fu) << shift;
+            if ((byte & 0x80u) == 0u)
+            {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t Zig()
+    {
+        const uint64_t v = Var();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1u);
+    }
+
+    template <typename T>
+    T Raw()
+    {
+        T value{};
+        if (!ok || static_cast<size_t>(end - at) < sizeof(T))
+        {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, at, sizeof(T));
+        at += sizeof(T);
+        return value;
+    }
+
+    // Caps a declared element count by the bytes left, so a corrupt count
+    // cannot drive a huge reserve.
+    uint32_t Count(size_t minBytesEach)
+    {
+        const uint64_t n = Var();
+        if (n > static_cast<uint64_t>(end - at) / std::max<size_t>(minBytesEach, 1u))
+        {
+            ok = false;
+            return 0;
+        }
+        return static_cast<uint32_t>(n);
+    }
+};
+
+static void EncodeState(const HistoryState &state, std::vector<unsigned char> &out)
+{
+    out.clear();
+    PutVar(out, state.flagWords.size());
+    const size_t nonZero = static_cast<size_t>(std::count_if(state.flagWords.begin(), state.flagWords.end(), [](uint64_t w)
+                                                             { return w != 0u; }));
+    PutVar(out, nonZero);
+    for (size_t w = 0; w < state.flagWords.size(); ++w)
+    {
+        if (state.flagWords[w] != 0u)
+        {
+            PutVar(out, w);
+            PutRaw(out, state.flagWords[w]);
+        }
+    }
+    PutZig(out, state.composure);
+    PutZig(out, state.crewTrust);
+    PutZig(out, state.threat);
+    PutVar(out, state.quests.size());
+    for (const HistoryQuest &quest : state.quests)
+    {
+        out.push_back(static_cast<unsigned char>(quest.state));
+        PutVar(out, quest.objectiveIndex);
+    }
+}
+
+static bool DecodeState(HistoryReader &in, HistoryState &state)
+{
+    const uint64_t wordCount = in.Var();
+    const uint32_t nonZero = in.Count(9u);
+    if (!in.ok || wordCount > (uint64_t{1} << 20) || nonZero > wordCount)
+    {
+        in.ok = false;
+        return false;
+    }
+    state.flagWords.assign(static_cast<size_t>(wordCount), 0u);
+    for (uint32_t i = 0; i < nonZero && in.ok; ++i)
+    {
+        const uint64_t w = in.Var();
+        const uint64_t bits = in.Raw<uint64_t>();
+        if (w >= wordCount)
+        {
+            in.ok = false;
+            return false;
+        }
+        state.flagWords[static_cast<size_t>(w)] = bits;
+    }
+    state.composure = static_cast<int>(in.Zig());
+    state.crewTrust = static_cast<int>(in.Zig());
+    state.threat = static_cast<int>(in.Zig());
+    state.quests.resize(in.Count(2u));
+    for (HistoryQuest &quest : state.quests)
+    {
+        const uint8_t s = in.Raw<uint8_t>();
+        quest.objectiveIndex = static_cast<uint32_t>(in.Var());
+        if (s > static_cast<uint8_t>(QuestState::Completed))
+        {
+            in.ok = false;
+            return false;
+        }
+        quest.state = static_cast<QuestState>(s);
+    }
+    return in.ok;
+}
+
+// One delta group: toggled flag bits (ascending, gap-coded), stat deltas,
+// then the quests whose state changed.
+static void EncodeDelta(const HistoryState &from, const HistoryState &to, std::vector<unsigned char> &out)
+{
+    const size_t words = std::max(from.flagWords.size(), to.flagWords.size());
+    const auto word = [](const std::vector<uint64_t> &v, size_t w)
+    { return w < v.size() ? v[w] : uint64_t{0}; };
+
+    uint64_t toggled = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t x = word(from.flagWords, w) ^ word(to.flagWords, w);
+        for (; x != 0u; x &= x - 1u)
+        {
+            ++toggled;
+        }
+    }
+    PutVar(out, toggled);
+    uint64_t previous = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        const uint64_t x = word(from.flagWords, w) ^ word(to.flagWords, w);
+        for (unsigned b = 0; b < 64u; ++b)
+        {
+            if (((x >> b) & 1u) != 0u)
+            {
+                const uint64_t bit = w * 64u + b;
+                PutVar(out, bit - previous);
+                previous = bit;
+            }
+        }
+    }
+
+    PutZig(out, to.composure - from.composure);
+    PutZig(out, to.crewTrust - from.crewTrust);
+    PutZig(out, to.threat - from.threat);
+
+    uint64_t changed = 0;
+    for (size_t q = 0; q < to.quests.size(); ++q)
+    {
+        const HistoryQuest before = q < from.quests.size() ? from.quests[q] : HistoryQuest{};
+        if (before.state != to.quests[q].state || before.objectiveIndex != to.quests[q].objectiveIndex)
+        {
+            ++changed;
+        }
+    }
+    PutVar(out, changed);
+    for (size_t q = 0; q < to.quests.size(); ++q)
+    {
+        const HistoryQuest before = q < from.quests.size() ? from.quests[q] : HistoryQuest{};
+        if (before.state != to.quests[q].state || before.objectiveIndex != to.quests[q].objectiveIndex)
+        {
+            PutVar(out, q);
+            out.push_back(static_cast<unsigned char>(to.quests[q].state));
+            PutVar(out, to.quests[q].objectiveIndex);
+        }
+    }
+}
+
+static bool ApplyDelta(HistoryReader &in, HistoryState &state)
+{
+    const uint32_t toggled = in.Count(1u);
+    uint64_t bit = 0;
+    for (uint32_t i = 0; i < toggled && in.ok; ++i)
+    {
+        bit += in.Var();
+        const size_t w = static_cast<size_t>(bit / 64u);
+        if (w >= (size_t{1} << 20))
+        {
+            in.ok = false;
+            return false;
+        }
+        if (w >= state.flagWords.size())
+        {
+            state.flagWords.resize(w + 1u, 0u);
+        }
+        state.flagWords[w] ^= uint64_t{1} << (bit % 64u);
+    }
+    state.composure += static_cast<int>(in.Zig());
+    state.crewTrust += static_cast<int>(in.Zig());
+    state.threat += static_cast<int>(in.Zig());
+    const uint32_t changed = in.Count(3u);
+    for (uint32_t i = 0; i < changed && in.ok; ++i)
+    {
+        const uint64_t q = in.Var();
+        const uint8_t s = in.Raw<uint8_t>();
+        const uint32_t objective = static_cast<uint32_t>(in.Var());
+        if (q >= (uint64_t{1} << 16) || s > static_cast<uint8_t>(QuestState::Completed))
+        {
+            in.ok = false;
+            return false;
+        }
+        if (q >= state.quests.size())
+        {
+            state.quests.resize(static_cast<size_t>(q) + 1u);
+        }
+        state.quests[static_cast<size_t>(q)] = HistoryQuest{static_cast<QuestState>(s), objective};
+    }
+    return in.ok;
+}
+
+void SaveHistory::Reset()
+{
+    log.clear();
+    keyframes.clear();
+    markers.clear();
+    last = HistoryState{};
+}
+
+void SaveHistory::Mark(const HistoryState &now, int node, const std::string &sceneId, Vector2 position)
+{
+    EncodeDelta(last, now, log);
+    const uint32_t logEnd = static_cast<uint32_t>(log.size());
+    if (keyframes.empty() || logEnd - keyframes.back().logEnd >= keyframes.back().bytes.size())
+    {
+        Keyframe keyframe;
+        keyframe.logEnd = logEnd;
+        EncodeState(now, keyframe.bytes);
+        keyframes.push_back(std::move(keyframe));
+    }
+
+    HistoryMarker marker;
+    marker.logEnd = logEnd;
+    marker.keyframe = static_cast<uint32_t>(keyframes.size() - 1u);
+    marker.node = node;
+    marker.sceneId = sceneId;
+    marker.position = position;
+    markers.push_back(std::move(marker));
+    last = now;
+}
+
+size_t SaveHistory::Bytes() const
+{
+    size_t bytes = log.size();
+    for (const Keyframe &keyframe : keyframes)
+    {
+        bytes += keyframe.bytes.size();
+    }
+    return bytes;
+}
+
+void SaveHistory::StateAt(size_t i, HistoryState &out) const
+{
+    const HistoryMarker &marker = markers[i];
+    const Keyframe &keyframe = keyframes[marker.keyframe];
+    HistoryReader state{keyframe.bytes.data(), keyframe.bytes.data() + keyframe.bytes.size()};
+    DecodeState(state, out);
+    HistoryReader deltas{log.data() + keyframe.logEnd, log.data() + marker.logEnd};
+    while (deltas.at < deltas.end && ApplyDelta(deltas, out))
+    {
+    }
+}
+
+void SaveHistory::Rewind(size_t i, HistoryState &out, HistoryMarker &marker)
+{
+    StateAt(i, out);
+    marker = markers[i];
+    log.resize(marker.logEnd);
+    while (!keyframes.empty() && keyframes.back().logEnd > marker.logEnd)
+    {
+        keyframes.pop_back();
+    }
+    markers.resize(i);
+    last = out;
+}
+
+void SaveHistory::Encode(std::vector<unsigned char> &out) const
+{
+    PutVar(out, log.size());
+    out.insert(out.end(), log.begin(), log.end());
+    PutVar(out, keyframes.size());
+    for (const Keyframe &keyframe : keyframes)
+    {
+        PutVar(out, keyframe.logEnd);
+        PutVar(out, keyframe.bytes.size());
+        out.insert(out.end(), keyframe.bytes.begin(), keyframe.bytes.end());
+    }
+    PutVar(out, markers.size());
+    for (const HistoryMarker &marker : markers)
+    {
+        PutVar(out, marker.logEnd);
+        PutVar(out, marker.keyframe);
+        PutZig(out, marker.node);
+        PutVar(out, marker.sceneId.size());
+        out.insert(out.end(), marker.sceneId.begin(), marker.sceneId.end());
+        PutRaw(out, marker.position.x);
+        PutRaw(out, marker.position.y);
+    }
+}
+
+bool SaveHistory::Decode(const unsigned char *data, size_t size)
+{
+    Reset();
+    HistoryReader in{data, data + size};
+    const uint32_t logSize = in.Count(1u);
+    if (in.ok)
+    {
+        log.assign(in.at, in.at + logSize);
+        in.at += logSize;
+    }
+
+    keyframes.resize(in.Count(2u));
+    for (Keyframe &keyframe : keyframes)
+    {
+        keyframe.logEnd = static_cast<uint32_t>(in.Var());
+        const uint32_t bytes = in.Count(1u);
+        if (!in.ok || keyframe.logEnd > log.size())
+        {
+            in.ok = false;
+            break;
+        }
+        keyframe.bytes.assign(in.at, in.at + bytes);
+        in.at += bytes;
+        HistoryState probe;
+        HistoryReader check{keyframe.bytes.data(), keyframe.bytes.data() + keyframe.bytes.size()};
+        if (!DecodeState(check, probe) || check.at != check.end)
+        {
+            in.ok = false;
+            break;
+        }
+    }
+
+    markers.resize(in.ok ? in.Count(10u) : 0u);
+    for (HistoryMarker &marker : markers)
+    {
+        marker.logEnd = static_cast<uint32_t>(in.Var());
+        marker.keyframe = static_cast<uint32_t>(in.Var());
+        marker.node = static_cast<int>(in.Zig());
+        const uint32_t length = in.Count(1u);
+        if (!in.ok || marker.logEnd > log.size() || marker.keyframe >= keyframes.size() ||
+            keyframes[marker.keyframe].logEnd > marker.logEnd)
+        {
+            in.ok = false;
+            break;
+        }
+        marker.sceneId.assign(reinterpret_cast<const char *>(in.at), length);
+        in.at += length;
+        marker.position.x = in.Raw<float>();
+        marker.position.y = in.Raw<float>();
+    }
+
+    // Every delta group must parse, or a later rewind would read garbage.
+    if (in.ok && in.at == in.end)
+    {
+        HistoryState scratch;
+        HistoryReader deltas{log.data(), log.data() + log.size()};
+        while (deltas.at < deltas.end && ApplyDelta(deltas, scratch))
+        {
+        }
+        in.ok = deltas.ok && deltas.at == deltas.end;
+    }
+    if (!in.ok || in.at != in.end)
+    {
+        Reset();
+        return false;
+    }
+    if (!markers.empty())
+    {
+        StateAt(markers.size() - 1u, last);
+    }
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "quests.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct HistoryQuest
+{
+    QuestState state = QuestState::Locked;
+    uint32_t objectiveIndex = 0;
+};
+
+// The narrative state a rewind restores. Quests are in pack order.
+struct HistoryState
+{
+    std::vector<uint64_t> flagWords;
+    int composure = 0;
+    int crewTrust = 0;
+    int threat = 0;
+    std::vector<HistoryQuest> quests;
+};
+
+// Where the player stood just before a dialogue choice.
+struct HistoryMarker
+{
+    uint32_t logEnd = 0;   // end of this marker's delta group in the log
+    uint32_t keyframe = 0; // nearest keyframe at or before logEnd
+    int node = -1;
+    std::string sceneId;
+    Vector2 position{};
+};
+
+// Choice history as a delta log with periodic keyframes. Each marker appends
+// one group: flag bits that toggled, stat deltas and changed quests, all
+// varint-coded, so a typical choice costs a handful of bytes. A full
+// keyframe is taken once the deltas since the previous one outgrow it, which
+// keeps total size proportional to the number of changes and bounds the
+// replay for any marker to roughly one keyframe's worth of deltas.
+class SaveHistory
+{
+public:
+    void Reset();
+
+    // Records the state in effect before the choice at node.
+    void Mark(const HistoryState &now, int node, const std::string &sceneId, Vector2 position);
+
+    size_t Size() const { return markers.size(); }
+    const HistoryMarker &Marker(size_t i) const { return markers[i]; }
+    size_t Bytes() const;
+
+    void StateAt(size_t i, HistoryState &out) const;
+
+    // Restores marker i and drops it and everything after, so the next
+    // choice starts a new branch from there.
+    void Rewind(size_t i, HistoryState &out, HistoryMarker &marker);
+
+    void Encode(std::vector<unsigned char> &out) const;
+    bool Decode(const unsigned char *data, size_t size);
+
+private:
+    struct Keyframe
+    {
+        uint32_t logEnd = 0;
+        std::vector<unsigned char> bytes;
+    };
+
+    std::vector<unsigned char> log;
+    std::vector<Keyframe> keyframes;
+    std::vector<HistoryMarker> markers;
+    HistoryState last; // state at the newest marker, the base for the next delta
+};
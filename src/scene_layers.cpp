@@ -0,0 +1,161 @@
+#include "scene_layers.h"
+
+#include <algorithm>
+#include <cmath>
+
+SceneLayers BuildSceneLayers(const ContentPack &content, const PackScene &scene)
+{
+    std::vector<RenderLayer> byPass[kLayerPassCount];
+    for (const auto &record : content.Layers(scene))
+    {
+        if (record.pass >= kLayerPassCount || record.kind > static_cast<uint8_t>(PackLayerKind::Line) ||
+            record.wave > static_cast<uint8_t>(PackLayerWave::Alpha))
+        {
+            continue;
+        }
+        RenderLayer layer;
+        layer.kind = static_cast<PackLayerKind>(record.kind);
+        layer.wave = static_cast<PackLayerWave>(record.wave);
+        layer.color = Color{record.color[0], record.color[1], record.color[2], record.color[3]};
+        std::copy(record.frac, record.frac + 4, layer.frac);
+        std::copy(record.px, record.px + 4, layer.px);
+        layer.thickness = record.thickness > 0.0f ? record.thickness : 1.0f;
+        layer.waveAmp = record.waveAmp;
+        layer.waveFreq = record.waveFreq;
+        layer.wavePhaseStep = record.wavePhaseStep;
+        layer.repeatFirst = record.repeatFirst;
+        layer.repeatCount = static_cast<int>(record.repeatCount);
+        layer.repeatStep = Vector2{record.repeatStep[0], record.repeatStep[1]};
+        layer.scrollSpeed = record.scrollSpeed;
+        layer.scrollPeriod = record.scrollPeriod;
+        byPass[record.pass].push_back(layer);
+    }
+
+    SceneLayers out;
+    for (const auto &record : content.Images(scene))
+    {
+        if (record.pass >= kLayerPassCount || record.path.length == 0)
+        {
+            continue;
+        }
+        SceneImage image;
+        image.path = std::string(content.Str(record.path));
+        image.pass = static_cast<PackLayerPass>(record.pass);
+        std::copy(record.frac, record.frac + 4, image.frac);
+        std::copy(record.px, record.px + 4, image.px);
+        out.images.push_back(std::move(image));
+    }
+    for (size_t p = 0; p < kLayerPassCount; ++p)
+    {
+        out.passStart[p] = out.layers.size();
+        out.layers.insert(out.layers.end(), byPass[p].begin(), byPass[p].end());
+    }
+    out.passStart[kLayerPassCount] = out.layers.size();
+    return out;
+}
+
+static void DrawShape(const RenderLayer &layer, const float *v, Color color)
+{
+    switch (layer.kind)
+    {
+    case PackLayerKind::Rect:
+        DrawRectangleRec(Rectangle{v[0], v[1], v[2], v[3]}, color);
+        break;
+    case PackLayerKind::Frame:
+        DrawRectangleLinesEx(Rectangle{v[0], v[1], v[2], v[3]}, layer.thickness, color);
+        break;
+    case PackLayerKind::Glow:
+        DrawCircleGradient(static_cast<int>(v[0]), static_cast<int>(v[1]), v[2], color, BLANK);
+        break;
+    case PackLayerKind::Line:
+        DrawLineEx(Vector2{v[0], v[1]}, Vector2{v[2], v[3]}, layer.thickness, color);
+        break;
+    }
+}
+
+void DrawSceneLayers(const SceneLayers &layers, PackLayerPass pass, Vector2 extent, Vector2 origin, float t)
+{
+    const size_t p = static_cast<size_t>(pass);
+    if (p >= kLayerPassCount)
+    {
+        return;
+    }
+    for (size_t li = layers.passStart[p]; li < layers.passStart[p + 1]; ++li)
+    {
+        const RenderLayer &layer = layers.layers[li];
+        float base[4];
+        for (size_t s = 0; s < 4; ++s)
+        {
+            base[s] = layer.frac[s] * (s % 2 == 0 ? extent.x : extent.y) + layer.px[s];
+        }
+        const float scroll = layer.scrollPeriod > 0.0f ? std::fmod(t * layer.scrollSpeed, layer.scrollPeriod) : 0.0f;
+
+        for (int r = 0; r < layer.repeatCount; ++r)
+        {
+            const float i = static_cast<float>(layer.repeatFirst + r);
+            const float dx = origin.x + layer.repeatStep.x * i + scroll;
+            const float dy = origin.y + layer.repeatStep.y * i;
+            float v[4] = {base[0] + dx, base[1] + dy, base[2], base[3]};
+            if (layer.kind == PackLayerKind::Line)
+            {
+                v[2] += dx;
+                v[3] += dy;
+            }
+
+            Color color = layer.color;
+            if (layer.wave != PackLayerWave::None)
+            {
+                const float wave = std::sin(t * layer.waveFreq + i * layer.wavePhaseStep) * layer.waveAmp;
+                switch (layer.wave)
+                {
+                case PackLayerWave::X:
+                    v[0] += wave;
+                    break;
+                case PackLayerWave::Y:
+                    v[1] += wave;
+                    break;
+                case PackLayerWave::Size:
+                    v[2] += wave;
+                    break;
+                case PackLayerWave::Alpha:
+                    color.a = static_cast<unsigned char>(std::clamp(static_cast<int>(color.a) + static_cast<int>(wave), 0, 255));
+                    break;
+                case PackLayerWave::None:
+                    break;
+                }
+            }
+            DrawShape(layer, v, color);
+        }
+    }
+}
+
+void RequestSceneImages(const SceneLayers &layers, AssetStreamer &streamer, bool urgent)
+{
+    for (const auto &image : layers.images)
+    {
+        streamer.Request(image.path, urgent);
+    }
+}
+
+void DrawSceneImages(const SceneLayers &layers, PackLayerPass pass, Vector2 extent, AssetStreamer &streamer)
+{
+    for (const auto &image : layers.images)
+    {
+        if (image.pass != pass)
+        {
+            continue;
+        }
+        const Texture2D *texture = streamer.Find(image.path);
+        if (texture == nullptr)
+        {
+            continue;
+        }
+        const Rectangle dest{
+            image.frac[0] * extent.x + image.px[0],
+            image.frac[1] * extent.y + image.px[1],
+            image.frac[2] * extent.x + image.px[2],
+            image.frac[3] * extent.y + image.px[3]};
+        const Rectangle source{0.0f, 0.0f, static_cast<float>(texture->width), static_cast<float>(texture->height)};
+        DrawTexturePro(*texture, source, dest, Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+    }
+}
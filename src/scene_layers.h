@@ -0,0 +1,62 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "asset_stream.h"
+#include "content_pack.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr size_t kLayerPassCount = static_cast<size_t>(PackLayerPass::Count);
+
+// A scene layer resolved from the pack once at load: enums checked, colors
+// converted, geometry kept as fraction-of-extent plus pixels.
+struct RenderLayer
+{
+    PackLayerKind kind = PackLayerKind::Rect;
+    PackLayerWave wave = PackLayerWave::None;
+    Color color{};
+    float frac[4] = {};
+    float px[4] = {};
+    float thickness = 1.0f;
+    float waveAmp = 0.0f;
+    float waveFreq = 0.0f;
+    float wavePhaseStep = 0.0f;
+    int repeatFirst = 0;
+    int repeatCount = 1;
+    Vector2 repeatStep{};
+    float scrollSpeed = 0.0f;
+    float scrollPeriod = 0.0f;
+};
+
+// A painted layer streamed through AssetStreamer; drawn under the procedural
+// layers of its pass once resident.
+struct SceneImage
+{
+    std::string path;
+    PackLayerPass pass = PackLayerPass::Backdrop;
+    float frac[4] = {};
+    float px[4] = {};
+};
+
+// Layers grouped by pass; pass p is layers[passStart[p], passStart[p + 1]).
+struct SceneLayers
+{
+    std::vector<RenderLayer> layers;
+    size_t passStart[kLayerPassCount + 1] = {};
+    std::vector<SceneImage> images;
+};
+
+// Records with an unknown pass or kind are dropped.
+SceneLayers BuildSceneLayers(const ContentPack &content, const PackScene &scene);
+
+// Draws one pass. Geometry fractions scale by extent and every layer is
+// offset by origin (the player position for the light pass).
+void DrawSceneLayers(const SceneLayers &layers, PackLayerPass pass, Vector2 extent, Vector2 origin, float t);
+
+void RequestSceneImages(const SceneLayers &layers, AssetStreamer &streamer, bool urgent);
+// Draws the resident images of one pass; missing ones are skipped.
+void DrawSceneImages(const SceneLayers &layers, PackLayerPass pass, Vector2 extent, AssetStreamer &streamer);
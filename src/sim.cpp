@@ -0,0 +1,773 @@
+#include "sim.h"
+
+#include "conditions.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "raymath.h"
+
+#include <algorithm>
+
+static bool AddFlag(SimWorld &world, FlagId flag)
+{
+    if (!world.flags.Set(flag))
+    {
+        return false;
+    }
+    world.questTracker.NotifyFlag(flag);
+    world.eventDirector.NotifyFlag(flag);
+    return true;
+}
+
+static bool ConditionHolds(const SimWorld &world, PackSpan<PackCondOp> condition)
+{
+    const int stats[] = {world.commandState.composure, world.commandState.crewTrust, world.commandState.threat};
+    return EvaluateCondition(condition, world.flags, stats);
+}
+
+// Linear over a handful of quests, and unlike a map lookup it needs no
+// std::string key built from the pack's string view.
+static Quest *FindQuest(SimWorld &world, std::string_view id)
+{
+    for (Quest *quest : world.questOrder)
+    {
+        if (quest->id == id)
+        {
+            return quest;
+        }
+    }
+    return nullptr;
+}
+
+bool ChoiceUnlocked(const SimWorld &world, const PackChoice &c)
+{
+    return ConditionHolds(world, world.content->Condition(c));
+}
+
+static bool ObjectiveDone(const QuestObjective &objective, const FlagSet &flags)
+{
+    return flags.Any(objective.doneMask);
+}
+
+static void StartQuest(Quest &q, QuestTracker &tracker, Chronicle &log)
+{
+    if (q.state != QuestState::Locked)
+    {
+        return;
+    }
+    q.state = QuestState::Active;
+    q.objectiveIndex = 0;
+    tracker.Touch(q);
+    log.Pushf("QUEST STARTED // %s", q.title.c_str());
+}
+
+static void ProgressQuest(Quest &q, const FlagSet &flags, Chronicle &log)
+{
+    if (q.state != QuestState::Active)
+    {
+        return;
+    }
+
+    while (q.objectiveIndex < q.objectives.size() &&
+           ObjectiveDone(q.objectives[q.objectiveIndex], flags))
+    {
+        log.Pushf("OBJECTIVE CLEARED // %s", q.objectives[q.objectiveIndex].text.c_str());
+        ++q.objectiveIndex;
+    }
+
+    if (q.objectiveIndex >= q.objectives.size())
+    {
+        q.state = QuestState::Completed;
+        log.Pushf("QUEST COMPLETE // %s", q.title.c_str());
+    }
+}
+
+int ClampStat(int value)
+{
+    return std::clamp(value, 0, 100);
+}
+
+static void ApplyChoiceImpact(
+    const ContentPack &content,
+    const PackChoice &choice,
+    CommandState &commandState,
+    Chronicle &chronicle)
+{
+    const int prevComposure = commandState.composure;
+    const int prevTrust = commandState.crewTrust;
+    const int prevThreat = commandState.threat;
+
+    commandState.composure = ClampStat(commandState.composure + choice.composureDelta);
+    commandState.crewTrust = ClampStat(commandState.crewTrust + choice.crewTrustDelta);
+    commandState.threat = ClampStat(commandState.threat + choice.threatDelta);
+
+    if (commandState.composure != prevComposure || commandState.crewTrust != prevTrust || commandState.threat != prevThreat)
+    {
+        chronicle.Pushf(
+            "SYSTEM SHIFT // C:%+d T:%+d TH:%+d",
+            commandState.composure - prevComposure,
+            commandState.crewTrust - prevTrust,
+            commandState.threat - prevThreat);
+    }
+
+    chronicle.Push(content.Str(choice.consequenceLine));
+}
+
+static Color PackColor(const uint8_t (&c)[4])
+{
+    return Color{c[0], c[1], c[2], c[3]};
+}
+
+static std::vector<Vector2> PackPolygon(const ContentPack &content, const PackRing &ring)
+{
+    std::vector<Vector2> polygon;
+    for (const auto &p : content.Points(ring))
+    {
+        polygon.push_back(Vector2{p.x, p.y});
+    }
+    return polygon;
+}
+
+static bool LoadScenes(const ContentPack &content, std::unordered_map<std::string, Scene> &scenes, std::string &error)
+{
+    std::vector<Scene> loaded;
+    loaded.reserve(content.Scenes().size());
+    for (const auto &record : content.Scenes())
+    {
+        Scene scene;
+        scene.id = std::string(content.Str(record.id));
+        scene.topColor = PackColor(record.topColor);
+        scene.bottomColor = PackColor(record.bottomColor);
+        scene.cameraTarget = Vector2{record.cameraTarget[0], record.cameraTarget[1]};
+        scene.cameraOffsetNorm = Vector2{record.cameraOffsetNorm[0], record.cameraOffsetNorm[1]};
+        scene.cameraZoom = record.cameraZoom;
+        scene.ambientBeat = record.ambientBeat;
+        scene.ambientJitter = record.ambientJitter;
+        scene.walkPolygon = PackPolygon(content, record.walk);
+        for (const auto &hole : content.Holes(record))
+        {
+            scene.walkHoles.push_back(PackPolygon(content, hole));
+        }
+        for (const auto &h : content.Hotspots(record))
+        {
+            Hotspot hotspot;
+            hotspot.area = Rectangle{h.area[0], h.area[1], h.area[2], h.area[3]};
+            hotspot.label = std::string(content.Str(h.label));
+            hotspot.dialogueNode = h.dialogueNode;
+            hotspot.transitionTo = std::string(content.Str(h.transitionTo));
+            hotspot.spawnPosition = Vector2{h.spawn[0], h.spawn[1]};
+            hotspot.z = h.z;
+            hotspot.outline = PackPolygon(content, h.outline);
+            const PackSpan<uint32_t> bits = content.MaskBits(h);
+            if (h.maskWidth > 0 && h.maskHeight > 0 && !bits.empty())
+            {
+                hotspot.mask.width = h.maskWidth;
+                hotspot.mask.height = h.maskHeight;
+                hotspot.mask.bits.assign(bits.begin(), bits.end());
+            }
+            scene.hotspots.push_back(std::move(hotspot));
+        }
+        BuildHotspotIndex(scene.hotspots, scene.hotspotIndex);
+        scene.flavorText = std::string(content.Str(record.flavorText));
+        scene.artDirection = std::string(content.Str(record.artDirection));
+        scene.layers = BuildSceneLayers(content, record);
+        scene.emitters = BuildEmitters(content, record);
+        scene.post = PostFxFromPack(record.post);
+        loaded.push_back(std::move(scene));
+    }
+
+    // Meshes are built here rather than on the first click, so entering a
+    // room never stalls a tick on triangulation. Scenes are independent, so
+    // each one triangulates as its own job; errors are reported in pack order.
+    std::vector<std::string> meshErrors(loaded.size());
+    std::vector<uint8_t> meshBuilt(loaded.size(), 0);
+    Jobs().ParallelFor(loaded.size(), 1, [&](size_t begin, size_t end)
+                       {
+        for (size_t i = begin; i < end; ++i)
+        {
+            meshBuilt[i] = BuildNavMesh(loaded[i].walkPolygon, loaded[i].walkHoles, loaded[i].navMesh, meshErrors[i]);
+        } });
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        if (!meshBuilt[i])
+        {
+            error = "scene '" + loaded[i].id + "': " + meshErrors[i];
+            return false;
+        }
+    }
+    for (Scene &scene : loaded)
+    {
+        scenes[scene.id] = std::move(scene);
+    }
+    return true;
+}
+
+static void LoadQuests(const ContentPack &content, std::unordered_map<std::string, Quest> &quests)
+{
+    for (const auto &record : content.Quests())
+    {
+        Quest quest;
+        quest.id = std::string(content.Str(record.id));
+        quest.title = std::string(content.Str(record.title));
+        quest.purpose = std::string(content.Str(record.purpose));
+        for (const auto &objective : content.Objectives(record))
+        {
+            QuestObjective loaded;
+            loaded.text = std::string(content.Str(objective.text));
+            for (const uint32_t flag : content.ObjectiveFlags(objective))
+            {
+                loaded.doneMask.Add(flag);
+            }
+            quest.objectives.push_back(std::move(loaded));
+        }
+        quests[quest.id] = std::move(quest);
+    }
+}
+
+// Pack flag ids are dense and ordered, so interning them first keeps
+// registry ids identical to the ids baked into choice and event records.
+static bool LoadFlagNames(const ContentPack &content, FlagRegistry &registry)
+{
+    FlagId expected = 0;
+    for (const auto &name : content.Flags())
+    {
+        if (registry.Intern(std::string(content.Str(name))) != expected++)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t HashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template <typename T>
+static uint64_t HashValue(uint64_t hash, const T &value)
+{
+    return HashBytes(hash, &value, sizeof(T));
+}
+
+// Identifies what history ids refer to: flag names and quest ids in pack
+// order, and the node table size.
+static uint64_t ContentFingerprint(const ContentPack &content)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const PackStr &flag : content.Flags())
+    {
+        const std::string_view name = content.Str(flag);
+        hash = HashBytes(hash, name.data(), name.size());
+        hash = HashValue(hash, name.size());
+    }
+    for (const auto &quest : content.Quests())
+    {
+        const std::string_view id = content.Str(quest.id);
+        hash = HashBytes(hash, id.data(), id.size());
+        hash = HashValue(hash, id.size());
+    }
+    return HashValue(hash, content.Nodes().size());
+}
+
+static void CaptureHistory(const SimWorld &world, HistoryState &state)
+{
+    state.flagWords = world.flags.Words();
+    state.composure = world.commandState.composure;
+    state.crewTrust = world.commandState.crewTrust;
+    state.threat = world.commandState.threat;
+    state.quests.clear();
+    for (const Quest *quest : world.questOrder)
+    {
+        state.quests.push_back(HistoryQuest{quest->state, static_cast<uint32_t>(quest->objectiveIndex)});
+    }
+}
+
+static void RewindChoice(SimWorld &world)
+{
+    if (world.history.Size() == 0)
+    {
+        world.chronicle.Push("REWIND // no earlier choice");
+        return;
+    }
+    HistoryState state;
+    HistoryMarker marker;
+    world.history.Rewind(world.history.Size() - 1u, state, marker);
+    if (world.scenes.find(marker.sceneId) == world.scenes.end() || world.content->Node(marker.node) == nullptr)
+    {
+        world.chronicle.Push("REWIND FAILED // choice no longer in content");
+        return;
+    }
+
+    world.flags.AssignWords(state.flagWords);
+    world.commandState.composure = state.composure;
+    world.commandState.crewTrust = state.crewTrust;
+    world.commandState.threat = state.threat;
+    for (size_t q = 0; q < world.questOrder.size() && q < state.quests.size(); ++q)
+    {
+        Quest &quest = *world.questOrder[q];
+        quest.state = state.quests[q].state;
+        quest.objectiveIndex = std::min(static_cast<size_t>(state.quests[q].objectiveIndex), quest.objectives.size());
+    }
+    world.questTracker.TouchAll();
+    world.eventDirector.Invalidate();
+
+    world.currentSceneId = marker.sceneId;
+    world.playerPos = marker.position;
+    world.targetPos = marker.position;
+    world.walkPath.clear();
+    world.walkPathIndex = 0;
+    world.isFading = false;
+    world.fadeAlpha = 0.0f;
+    world.pendingScene.clear();
+    world.activeDialogueNode = marker.node;
+    world.state = GameState::Dialogue;
+    world.chronicle.Pushf("REWIND // back to choice %zu in %s", world.history.Size() + 1u, marker.sceneId.c_str());
+}
+
+static void SaveSnapshot(SimWorld &world)
+{
+    SaveData data(&world.frameArena);
+    data.sceneId = world.currentSceneId;
+    data.playerPos = world.playerPos;
+    data.targetPos = world.targetPos;
+    data.composure = world.commandState.composure;
+    data.crewTrust = world.commandState.crewTrust;
+    data.threat = world.commandState.threat;
+    data.flags.reserve(world.flags.Count());
+    world.flags.ForEach([&](FlagId id)
+                        { data.flags.push_back(world.flagRegistry.Name(id)); });
+    data.quests.reserve(world.questOrder.size());
+    for (const Quest *quest : world.questOrder)
+    {
+        data.quests.push_back(SaveQuest{quest->id, quest->state, static_cast<uint32_t>(quest->objectiveIndex)});
+    }
+    world.historyBytes.clear();
+    world.history.Encode(world.historyBytes);
+    data.contentFingerprint = world.contentFingerprint;
+    data.history = world.historyBytes.data();
+    data.historySize = static_cast<uint32_t>(world.historyBytes.size());
+    EncodeSave(data, world.saveBytes);
+}
+
+static bool LoadSnapshot(SimWorld &world)
+{
+    // A save may still be on the writer thread; read what it will leave.
+    world.saveWriter.Flush();
+    // Saves from before the binary format still load from the old text file.
+    std::pmr::vector<unsigned char> bytes(&world.frameArena);
+    if (!ReadSaveFile(world.savePath, bytes) && !ReadSaveFile(world.legacySavePath, bytes))
+    {
+        world.chronicle.Push("LOAD FAILED // save file missing");
+        return false;
+    }
+
+    SaveData data(&world.frameArena);
+    std::string error;
+    if (!DecodeSave(bytes, data, error))
+    {
+        world.chronicle.Pushf("LOAD FAILED // %s", error.c_str());
+        return false;
+    }
+    if (data.skippedLines > 0)
+    {
+        world.chronicle.Pushf("LOAD WARNING // %u unknown lines skipped", static_cast<unsigned>(data.skippedLines));
+    }
+
+    const std::string sceneId(data.sceneId);
+    if (world.scenes.find(sceneId) == world.scenes.end())
+    {
+        world.chronicle.Push("LOAD FAILED // scene not found in current build");
+        return false;
+    }
+
+    world.currentSceneId = sceneId;
+    world.playerPos = data.playerPos;
+    world.targetPos = data.targetPos;
+    world.commandState.composure = ClampStat(data.composure);
+    world.commandState.crewTrust = ClampStat(data.crewTrust);
+    world.commandState.threat = ClampStat(data.threat);
+
+    world.flags.Clear();
+    world.flags.Reserve(world.flagRegistry.Size());
+    for (const std::string_view flag : data.flags)
+    {
+        world.flags.Set(world.flagRegistry.Intern(std::string(flag)));
+    }
+
+    for (const SaveQuest &saved : data.quests)
+    {
+        if (Quest *quest = FindQuest(world, saved.id))
+        {
+            quest->state = saved.state;
+            quest->objectiveIndex = std::min(static_cast<size_t>(saved.objectiveIndex), quest->objectives.size());
+        }
+    }
+
+    // Older saves and saves from another pack build carry no usable history.
+    if (data.historySize == 0 || data.contentFingerprint != world.contentFingerprint ||
+        !world.history.Decode(data.history, data.historySize))
+    {
+        world.history.Reset();
+    }
+
+    world.chronicle.Push("LOAD COMPLETE // command snapshot restored");
+    return true;
+}
+
+bool InitSim(const ContentPack &content, SimWorld &world, std::string &error)
+{
+    world.content = &content;
+    if (!LoadScenes(content, world.scenes, error))
+    {
+        return false;
+    }
+    LoadQuests(content, world.quests);
+    if (!LoadFlagNames(content, world.flagRegistry))
+    {
+        error = "duplicate flag names in pack";
+        return false;
+    }
+    if (world.scenes.find(world.currentSceneId) == world.scenes.end())
+    {
+        error = "pack has no '" + world.currentSceneId + "' scene";
+        return false;
+    }
+    world.flags.Reserve(world.flagRegistry.Size());
+    for (const auto &record : content.Quests())
+    {
+        const auto it = world.quests.find(std::string(content.Str(record.id)));
+        if (it != world.quests.end())
+        {
+            world.questOrder.push_back(&it->second);
+        }
+    }
+    world.questTracker.Build(world.questOrder, world.flagRegistry.Size());
+    world.eventDirector.Build(content, world.flagRegistry.Size());
+    world.contentFingerprint = ContentFingerprint(content);
+    world.targetPos = world.playerPos;
+    world.chronicle.Push("WORLD READY // Doctrine loaded");
+    return true;
+}
+
+const Scene &CurrentScene(const SimWorld &world)
+{
+    return world.scenes.at(world.currentSceneId);
+}
+
+static void UpdateAmbient(SimWorld &world, float dt)
+{
+    PROFILE_ZONE(ProfileZone::SimAmbient);
+    world.eventDirector.Advance(dt);
+    const Scene &scene = CurrentScene(world);
+    world.ambientTimer += dt;
+    if (world.ambientTimer < scene.ambientBeat + world.ambientDelay)
+    {
+        return;
+    }
+    world.ambientTimer = 0.0f;
+    world.ambientDelay = world.eventDirector.Jitter(scene.ambientJitter);
+    const int stats[] = {world.commandState.composure, world.commandState.crewTrust, world.commandState.threat};
+    const int picked = world.eventDirector.Pick(world.currentSceneId, world.flags, stats);
+    if (picked < 0)
+    {
+        return;
+    }
+    const PackEvent &event = world.content->Events()[static_cast<size_t>(picked)];
+    world.chronicle.Push(world.content->Str(event.line));
+    AddFlag(world, event.grantsFlag);
+    world.commandState.threat = ClampStat(world.commandState.threat + 2);
+    world.eventDirector.Fired(static_cast<uint32_t>(picked));
+}
+
+static void UpdateFreeRoam(SimWorld &world, const Scene &scene, const SimInput &input, float dt)
+{
+    const NavMesh &navMesh = scene.navMesh;
+    PROFILE_ZONE(ProfileZone::SimFreeRoam);
+    if (input.click)
+    {
+        const int picked = PickHotspot(scene.hotspots, scene.hotspotIndex, input.clickWorld);
+        if (picked >= 0)
+        {
+            const Hotspot &hotspot = scene.hotspots[static_cast<size_t>(picked)];
+            world.targetPos = ClampToWalkable(
+                navMesh.area,
+                Vector2{hotspot.area.x + hotspot.area.width * 0.5f, hotspot.area.y + hotspot.area.height * 0.5f});
+
+            if (!hotspot.transitionTo.empty())
+            {
+                world.pendingScene = hotspot.transitionTo;
+                world.pendingSpawn = hotspot.spawnPosition;
+                world.state = GameState::Transition;
+                world.isFading = true;
+                world.fadeDirection = 1.0f;
+            }
+            else if (hotspot.dialogueNode >= 0)
+            {
+                world.activeDialogueNode = hotspot.dialogueNode;
+                world.state = GameState::Dialogue;
+            }
+        }
+        else
+        {
+            world.targetPos = ClampToWalkable(navMesh.area, input.clickWorld);
+        }
+
+        if (!FindNavPath(navMesh, world.navQuery, world.playerPos, world.targetPos, world.walkPath))
+        {
+            world.walkPath.assign(1, world.targetPos);
+        }
+        world.walkPathIndex = 0;
+        if (!world.walkPath.empty())
+        {
+            world.targetPos = world.walkPath.back();
+        }
+    }
+
+    float budget = world.playerSpeed * dt;
+    while (world.walkPathIndex < world.walkPath.size() && budget > 0.0f)
+    {
+        const Vector2 waypoint = world.walkPath[world.walkPathIndex];
+        const float dist = Vector2Distance(world.playerPos, waypoint);
+        if (dist <= budget)
+        {
+            world.playerPos = waypoint;
+            budget -= dist;
+            ++world.walkPathIndex;
+            continue;
+        }
+        world.playerPos = Vector2MoveTowards(world.playerPos, waypoint, budget);
+        budget = 0.0f;
+    }
+}
+
+static void UpdateDialogue(SimWorld &world, const SimInput &input)
+{
+    PROFILE_ZONE(ProfileZone::SimDialogue);
+    const ContentPack &content = *world.content;
+    const PackNode *nodeRecord = content.Node(world.activeDialogueNode);
+    if (nodeRecord == nullptr)
+    {
+        world.state = GameState::FreeRoam;
+        world.activeDialogueNode = -1;
+        return;
+    }
+
+    const PackNode &node = *nodeRecord;
+    const PackSpan<PackChoice> choices = content.Choices(node);
+    if (input.choice < 0 || static_cast<uint32_t>(input.choice) >= choices.size())
+    {
+        return;
+    }
+
+    const PackChoice &pick = choices[static_cast<uint32_t>(input.choice)];
+    if (!ChoiceUnlocked(world, pick))
+    {
+        world.chronicle.Push("LOCKED CHOICE // requirement or rule block active");
+        return;
+    }
+
+    HistoryState before;
+    CaptureHistory(world, before);
+    world.history.Mark(before, world.activeDialogueNode, world.currentSceneId, world.playerPos);
+
+    world.chronicle.Pushf("%s: %s", content.CStr(node.speaker), content.CStr(node.line));
+    world.chronicle.Pushf("YOU: %s", content.CStr(pick.text));
+
+    if (AddFlag(world, pick.setFlag))
+    {
+        world.chronicle.Pushf("FLAG GAINED // %s", world.flagRegistry.Name(pick.setFlag).c_str());
+    }
+
+    ApplyChoiceImpact(content, pick, world.commandState, world.chronicle);
+
+    if (pick.startQuest.length > 0)
+    {
+        if (Quest *quest = FindQuest(world, content.Str(pick.startQuest)))
+        {
+            StartQuest(*quest, world.questTracker, world.chronicle);
+        }
+    }
+
+    world.questTracker.Flush([&](Quest &q)
+                             { ProgressQuest(q, world.flags, world.chronicle); });
+
+    world.activeDialogueNode = pick.nextNode;
+    if (world.activeDialogueNode < 0)
+    {
+        world.state = GameState::FreeRoam;
+    }
+}
+
+static void UpdateTransition(SimWorld &world, float dt)
+{
+    PROFILE_ZONE(ProfileZone::SimTransition);
+    world.fadeAlpha += world.fadeDirection * dt;
+    if (world.fadeDirection > 0.0f && world.fadeAlpha >= 1.0f)
+    {
+        world.fadeAlpha = 1.0f;
+        if (world.scenes.find(world.pendingScene) == world.scenes.end())
+        {
+            world.chronicle.Push("TRANSITION FAILED // target scene missing");
+            world.pendingScene = world.currentSceneId;
+            world.pendingSpawn = world.playerPos;
+        }
+        world.currentSceneId = world.pendingScene;
+        world.playerPos = world.pendingSpawn;
+        world.targetPos = world.pendingSpawn;
+        world.walkPath.clear();
+        world.walkPathIndex = 0;
+        world.fadeDirection = -1.0f;
+    }
+    else if (world.fadeDirection < 0.0f && world.fadeAlpha <= 0.0f)
+    {
+        world.fadeAlpha = 0.0f;
+        world.isFading = false;
+        world.state = GameState::FreeRoam;
+    }
+}
+
+bool StepSim(SimWorld &world, const SimInput &input, float dt)
+{
+    PROFILE_ZONE(ProfileZone::Sim);
+    ++world.frame;
+    world.frameArena.Reset(); // nothing from the previous step survives it
+    auto sceneIt = world.scenes.find(world.currentSceneId);
+    if (sceneIt == world.scenes.end())
+    {
+        world.chronicle.Push("SCENE ERROR // fallback to control_room");
+        world.currentSceneId = "control_room";
+        sceneIt = world.scenes.find(world.currentSceneId);
+        if (sceneIt == world.scenes.end())
+        {
+            world.chronicle.Push("SCENE ERROR // control_room missing, aborting");
+            world.chronicle.Drain();
+            return false;
+        }
+    }
+    const Scene &scene = sceneIt->second;
+
+    if (input.save)
+    {
+        // Same path as autosave: encode here, fsync on the writer thread.
+        SaveSnapshot(world);
+        world.saveWriter.Submit(world.savePath, world.saveBytes);
+        world.chronicle.Pushf("SAVE QUEUED // %s", world.savePath.c_str());
+    }
+    if (input.load)
+    {
+        if (LoadSnapshot(world))
+        {
+            world.questTracker.TouchAll();
+            world.eventDirector.Invalidate();
+            world.autosaveRevision = world.questTracker.Revision(); // nothing new to autosave
+            FindNavPath(CurrentScene(world).navMesh, world.navQuery, world.playerPos, world.targetPos, world.walkPath);
+            world.walkPathIndex = 0;
+        }
+    }
+    if (input.rewind)
+    {
+        RewindChoice(world);
+    }
+
+    UpdateAmbient(world, dt);
+    {
+        PROFILE_ZONE(ProfileZone::SimQuests);
+        world.questTracker.Flush([&](Quest &q)
+                                 { ProgressQuest(q, world.flags, world.chronicle); });
+    }
+
+    if (world.state == GameState::FreeRoam)
+    {
+        UpdateFreeRoam(world, scene, input, dt);
+    }
+    else if (world.state == GameState::Dialogue && world.activeDialogueNode >= 0)
+    {
+        UpdateDialogue(world, input);
+    }
+
+    if (world.state == GameState::Transition && world.isFading)
+    {
+        UpdateTransition(world, dt);
+    }
+
+    // Flag or quest progress this frame: encode here (microseconds) and let
+    // the writer thread pay for the disk.
+    if (world.autosave && world.questTracker.Revision() != world.autosaveRevision)
+    {
+        world.autosaveRevision = world.questTracker.Revision();
+        SaveSnapshot(world);
+        world.saveWriter.Submit(world.savePath, world.saveBytes);
+    }
+    if (const uint32_t failed = world.saveWriter.TakeFailures())
+    {
+        world.chronicle.Pushf("SAVE FAILED // %u writes did not reach disk", static_cast<unsigned>(failed));
+    }
+
+    world.chronicle.Drain();
+    return true;
+}
+
+void MergeInput(SimInput &pending, const SimInput &frame)
+{
+    if (frame.click)
+    {
+        pending.click = true;
+        pending.clickWorld = frame.clickWorld;
+    }
+    if (frame.choice >= 0)
+    {
+        pending.choice = frame.choice;
+    }
+    pending.save = pending.save || frame.save;
+    pending.load = pending.load || frame.load;
+    pending.rewind = pending.rewind || frame.rewind;
+}
+
+SimPose CapturePose(const SimWorld &world)
+{
+    return SimPose{&CurrentScene(world), world.playerPos, world.isFading ? world.fadeAlpha : 0.0f};
+}
+
+SimPose BlendPose(const SimPose &prev, const SimPose &next, float alpha)
+{
+    if (prev.scene != next.scene)
+    {
+        return next;
+    }
+    return SimPose{next.scene, Vector2Lerp(prev.playerPos, next.playerPos, alpha), Lerp(prev.fadeAlpha, next.fadeAlpha, alpha)};
+}
+
+uint64_t HashSimState(const SimWorld &world)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = HashValue(hash, world.frame);
+    hash = HashValue(hash, static_cast<int>(world.state));
+    hash = HashBytes(hash, world.currentSceneId.data(), world.currentSceneId.size());
+    hash = HashValue(hash, world.playerPos.x);
+    hash = HashValue(hash, world.playerPos.y);
+    hash = HashValue(hash, world.targetPos.x);
+    hash = HashValue(hash, world.targetPos.y);
+    hash = HashValue(hash, world.walkPathIndex);
+    hash = HashValue(hash, world.commandState.composure);
+    hash = HashValue(hash, world.commandState.crewTrust);
+    hash = HashValue(hash, world.commandState.threat);
+    hash = HashValue(hash, world.activeDialogueNode);
+    hash = HashValue(hash, world.ambientTimer);
+    hash = HashValue(hash, world.fadeAlpha);
+    hash = HashValue(hash, world.fadeDirection);
+    world.flags.ForEach([&](FlagId id)
+                        { hash = HashValue(hash, id); });
+    // Walk quests in pack order; map iteration order is not part of the state.
+    for (const Quest *quest : world.questOrder)
+    {
+        hash = HashValue(hash, static_cast<int>(quest->state));
+        hash = HashValue(hash, quest->objectiveIndex);
+    }
+    return hash;
+}
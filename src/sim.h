@@ -0,0 +1,149 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "chronicle.h"
+#include "content_pack.h"
+#include "event_director.h"
+#include "flags.h"
+#include "frame_arena.h"
+#include "hotspot_index.h"
+#include "navmesh.h"
+#include "particles.h"
+#include "post_fx.h"
+#include "quests.h"
+#include "save_game.h"
+#include "save_history.h"
+#include "scene_layers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Scene
+{
+    std::string id;
+    Color topColor{};
+    Color bottomColor{};
+    Vector2 cameraTarget{};
+    Vector2 cameraOffsetNorm{0.5f, 0.5f};
+    float cameraZoom = 0.62f;
+    std::vector<Vector2> walkPolygon;
+    std::vector<std::vector<Vector2>> walkHoles;
+    NavMesh navMesh; // built from the walk polygon and holes at load
+    std::vector<Hotspot> hotspots;
+    HotspotIndex hotspotIndex;
+    std::string flavorText;
+    std::string artDirection;
+    SceneLayers layers;
+    std::vector<ParticleEmitter> emitters;
+    PostFxSettings post;
+    float ambientBeat = 8.0f;
+    float ambientJitter = 0.0f;
+};
+
+struct CommandState
+{
+    int composure = 60;
+    int crewTrust = 55;
+    int threat = 30;
+};
+
+enum class GameState
+{
+    FreeRoam,
+    Dialogue,
+    Transition
+};
+
+// Everything the update step reads from the platform for one frame. The
+// window front end fills it from raylib input; headless runs read it from a
+// replay file, so the same stream always produces the same states.
+struct SimInput
+{
+    bool click = false;
+    Vector2 clickWorld{};
+    int choice = -1; // dialogue choice index picked this frame
+    bool save = false;
+    bool load = false;
+    bool rewind = false; // back to just before the latest dialogue choice
+};
+
+// Window-free game state: hotspot hits, movement, dialogue, ambient events,
+// quests and scene fades all advance through StepSim.
+struct SimWorld
+{
+    const ContentPack *content = nullptr;
+    std::unordered_map<std::string, Scene> scenes;
+    std::unordered_map<std::string, Quest> quests;
+    std::vector<Quest *> questOrder; // pack order, filled by InitSim
+    FlagRegistry flagRegistry;
+    FlagSet flags;
+    QuestTracker questTracker;
+    EventDirector eventDirector;
+    Chronicle chronicle;
+    FrameArena frameArena; // transient data of one StepSim, reset as the next starts
+    CommandState commandState{};
+    std::string savePath = "worldforge_save.wfs";
+    std::string legacySavePath = "worldforge_save.txt"; // read-only fallback
+    SaveWriter saveWriter;
+    std::vector<unsigned char> saveBytes; // encode scratch, swapped with the writer
+    bool autosave = false;                // write on flag/quest progress
+    uint64_t autosaveRevision = 0;
+    SaveHistory history;
+    std::vector<unsigned char> historyBytes;
+    uint64_t contentFingerprint = 0; // guards saved history against a different pack
+
+    GameState state = GameState::FreeRoam;
+    std::string currentSceneId = "control_room";
+    Vector2 playerPos{820.0f, 500.0f};
+    Vector2 targetPos{820.0f, 500.0f};
+    float playerSpeed = 180.0f;
+
+    NavQuery navQuery;
+    std::vector<Vector2> walkPath;
+    size_t walkPathIndex = 0;
+
+    int activeDialogueNode = -1;
+    float ambientTimer = 0.0f;
+    float ambientDelay = 0.0f; // jitter drawn for the current beat
+
+    bool isFading = false;
+    float fadeAlpha = 0.0f;
+    float fadeDirection = 1.0f;
+    std::string pendingScene;
+    Vector2 pendingSpawn{0.0f, 0.0f};
+
+    uint32_t frame = 0;
+};
+
+bool InitSim(const ContentPack &content, SimWorld &world, std::string &error);
+
+// Advances one frame. Returns false if the world cannot continue (no
+// playable scene left).
+bool StepSim(SimWorld &world, const SimInput &input, float dt);
+
+const Scene &CurrentScene(const SimWorld &world);
+bool ChoiceUnlocked(const SimWorld &world, const PackChoice &c);
+int ClampStat(int value);
+
+// Folds one rendered frame's input into input still waiting for a sim tick,
+// so a press on a frame that runs no tick reaches the next one.
+void MergeInput(SimInput &pending, const SimInput &frame);
+
+// The part of a sim state the renderer moves smoothly. Captured after each
+// tick; frames draw between the last two.
+struct SimPose
+{
+    const Scene *scene = nullptr;
+    Vector2 playerPos{};
+    float fadeAlpha = 0.0f;
+};
+
+SimPose CapturePose(const SimWorld &world);
+SimPose BlendPose(const SimPose &prev, const SimPose &next, float alpha); // snaps across scene changes
+
+// FNV-1a over the gameplay state, for replay regression checks.
+uint64_t HashSimState(const SimWorld &world);
@@ -0,0 +1,15 @@
+#include "sim_clock.h"
+
+#include <algorithm>
+
+uint32_t SimClock::Advance(float frameSeconds)
+{
+    accumulator += std::clamp(frameSeconds, 0.0f, kMaxFrameSeconds);
+    uint32_t ticks = 0;
+    while (accumulator >= tick)
+    {
+        accumulator -= tick;
+        ++ticks;
+    }
+    return ticks;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+constexpr float kSimTickSeconds = 1.0f / 120.0f;
+
+// Turns variable frame times into whole simulation ticks. The remainder
+// carries to the next frame and doubles as the interpolation factor between
+// the last two sim states. A frame longer than kMaxFrameSeconds (debugger
+// break, window drag) is clamped, so a stall costs a bounded number of
+// catch-up ticks instead of a spiral of ever longer frames.
+class SimClock
+{
+public:
+    static constexpr float kMaxFrameSeconds = 0.25f;
+
+    explicit SimClock(float tickSeconds = kSimTickSeconds) : tick(tickSeconds) {}
+
+    // Adds one frame's time and returns how many ticks to run now.
+    uint32_t Advance(float frameSeconds);
+
+    float Tick() const { return tick; }
+    float Alpha() const { return accumulator / tick; } // 0..1 into the next tick
+
+private:
+    float tick;
+    float accumulator = 0.0f;
+};
@@ -0,0 +1,204 @@
+#include "sim_thread.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <utility>
+
+bool InputQueue::Push(const SimInput &input)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= kSize)
+    {
+        return false;
+    }
+    slots[h & (kSize - 1u)] = input;
+    head.store(h + 1u, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::Pop(SimInput &input)
+{
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    input = slots[t & (kSize - 1u)];
+    tail.store(t + 1u, std::memory_order_release);
+    return true;
+}
+
+SimThread::~SimThread()
+{
+    Stop();
+}
+
+void SimThread::Start(SimWorld &simWorld, ReplayRecorder *replayRecorder, const std::string &primaryQuestId)
+{
+    world = &simWorld;
+    recorder = replayRecorder;
+    const auto quest = world->quests.find(primaryQuestId);
+    primaryQuest = quest != world->quests.end() ? &quest->second : nullptr;
+    previousPose = CapturePose(*world);
+    currentPose = previousPose;
+
+    // Publish the starting state so the first Acquire has something to draw.
+    Capture(buffers[ready], std::chrono::steady_clock::now());
+    fresh = true;
+    stopping = false;
+    finished.store(false, std::memory_order_relaxed);
+    worker = std::thread([this]
+                         { Run(); });
+}
+
+void SimThread::Stop()
+{
+    if (!worker.joinable())
+    {
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void SimThread::Submit(const SimInput &input)
+{
+    // The sim drains every tick, so a full queue means it has stalled for
+    // seconds; dropping input then is better than blocking the window.
+    inputs.Push(input);
+}
+
+void SimThread::Post(std::string_view line)
+{
+    posts.Push(line);
+}
+
+void SimThread::Postf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    posts.PushV(format, args);
+    va_end(args);
+}
+
+const FrameSnapshot &SimThread::Acquire()
+{
+    const std::lock_guard<std::mutex> lock(swapMutex);
+    if (fresh)
+    {
+        std::swap(front, ready);
+        fresh = false;
+    }
+    return buffers[front];
+}
+
+void SimThread::Capture(FrameSnapshot &snapshot, std::chrono::steady_clock::time_point now)
+{
+    const SimWorld &w = *world;
+    snapshot.taken = now;
+    snapshot.alpha = clock.Alpha();
+    snapshot.previous = previousPose;
+    snapshot.current = currentPose;
+    snapshot.state = w.state;
+    snapshot.activeDialogueNode = w.activeDialogueNode;
+    snapshot.choiceUnlocked.clear();
+    if (const PackNode *node = w.content->Node(w.activeDialogueNode))
+    {
+        for (const PackChoice &choice : w.content->Choices(*node))
+        {
+            snapshot.choiceUnlocked.push_back(ChoiceUnlocked(w, choice) ? 1u : 0u);
+        }
+    }
+    snapshot.isFading = w.isFading;
+    const auto pending = w.scenes.find(w.pendingScene);
+    snapshot.pendingScene = pending != w.scenes.end() ? &pending->second : nullptr;
+    snapshot.walkPath.assign(w.walkPath.begin() + static_cast<std::ptrdiff_t>(std::min(w.walkPathIndex, w.walkPath.size())), w.walkPath.end());
+
+    snapshot.commandState = w.commandState;
+    snapshot.flagCount = w.flags.Count();
+    snapshot.primaryQuest = primaryQuest;
+    if (primaryQuest != nullptr)
+    {
+        snapshot.primaryState = primaryQuest->state;
+        snapshot.primaryObjective = primaryQuest->objectiveIndex;
+    }
+
+    // Each buffer remembers which history it holds; copy only when stale.
+    if (snapshot.chronicleRevision != w.chronicle.Revision() || snapshot.chronicleCount != w.chronicle.Size())
+    {
+        snapshot.chronicleRevision = w.chronicle.Revision();
+        snapshot.chronicleCount = w.chronicle.Size();
+        for (size_t i = 0; i < snapshot.chronicleCount; ++i)
+        {
+            snapshot.chronicle[i].Assign(w.chronicle.Line(i));
+        }
+    }
+}
+
+void SimThread::Run()
+{
+    SetProfileLane(2);
+    using SteadyClock = std::chrono::steady_clock;
+    SteadyClock::time_point last = SteadyClock::now();
+    SimInput pending;
+    for (;;)
+    {
+        const SteadyClock::time_point now = SteadyClock::now();
+        const float elapsed = std::chrono::duration<float>(now - last).count();
+        last = now;
+
+        posts.Consume([this](const ChronicleLine &line) {
+            world->chronicle.Push(std::string_view(line.text, line.length));
+        });
+        if (const uint32_t lost = posts.TakeDropped())
+        {
+            world->chronicle.Pushf("CHRONICLE // %u posts dropped", static_cast<unsigned>(lost));
+        }
+
+        SimInput input;
+        while (inputs.Pop(input))
+        {
+            MergeInput(pending, input);
+        }
+
+        const uint32_t ticks = clock.Advance(elapsed);
+        for (uint32_t i = 0; i < ticks; ++i)
+        {
+            previousPose = currentPose;
+            if (recorder != nullptr)
+            {
+                recorder->Record(frames, pending);
+            }
+            if (!StepSim(*world, pending, clock.Tick()))
+            {
+                finished.store(true, std::memory_order_release);
+                return;
+            }
+            pending = SimInput{};
+            ++frames;
+            currentPose = CapturePose(*world);
+        }
+        if (ticks > 0)
+        {
+            Capture(buffers[back], now);
+            const std::lock_guard<std::mutex> lock(swapMutex);
+            std::swap(back, ready);
+            fresh = true;
+        }
+
+        // Sleep until the next tick is due, or until Stop.
+        const auto untilTick = std::chrono::duration<float>((1.0f - clock.Alpha()) * clock.Tick());
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (wake.wait_for(lock, untilTick, [this]
+                          { return stopping; }))
+        {
+            return;
+        }
+    }
+}
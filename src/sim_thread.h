@@ -0,0 +1,126 @@
+#pragma once
+
+#include "chronicle.h"
+#include "quests.h"
+#include "replay.h"
+#include "sim.h"
+#include "sim_clock.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Render -> sim input. One producer, one consumer, fixed capacity; the two
+// sides only share the indices, like the chronicle queue.
+class InputQueue
+{
+public:
+    bool Push(const SimInput &input); // false when the sim is kSize inputs behind
+    bool Pop(SimInput &input);
+
+private:
+    static constexpr uint32_t kSize = 256; // power of two
+
+    SimInput slots[kSize];
+    alignas(64) std::atomic<uint32_t> head{0}; // producer-owned
+    alignas(64) std::atomic<uint32_t> tail{0}; // consumer-owned
+};
+
+// Everything a rendered frame reads from the sim, copied after the newest
+// tick. Scene pointers refer to data the sim never changes after InitSim
+// (nav mesh and hotspot index included). StepSim does change a quest's
+// state and objective index, so through primaryQuest only the title,
+// purpose and objective texts may be read; state comes from primaryState
+// and primaryObjective.
+struct FrameSnapshot
+{
+    std::chrono::steady_clock::time_point taken{};
+    float alpha = 0.0f; // SimClock remainder when taken
+
+    SimPose previous;
+    SimPose current;
+    GameState state = GameState::FreeRoam;
+    int activeDialogueNode = -1;
+    std::vector<uint8_t> choiceUnlocked; // per choice of the active node
+    bool isFading = false;
+    const Scene *pendingScene = nullptr;
+    std::vector<Vector2> walkPath; // remaining waypoints
+
+    CommandState commandState{};
+    size_t flagCount = 0;
+    const Quest *primaryQuest = nullptr;
+    QuestState primaryState = QuestState::Locked;
+    size_t primaryObjective = 0;
+
+    uint64_t chronicleRevision = 0;
+    size_t chronicleCount = 0;
+    ChronicleLine chronicle[kChronicleHistory];
+};
+
+// Runs StepSim on its own thread at the SimClock rate, so the window thread
+// only draws. Input goes in through an InputQueue; each batch of ticks is
+// published as a FrameSnapshot. Snapshots are double-buffered with a
+// hand-off slot between the two sides: the sim fills its back buffer and
+// swaps it into the slot, the renderer swaps the slot into its front buffer,
+// and neither ever waits for the other beyond that pointer swap.
+class SimThread
+{
+public:
+    SimThread() = default;
+    SimThread(const SimThread &) = delete;
+    SimThread &operator=(const SimThread &) = delete;
+    ~SimThread();
+
+    // The world belongs to the sim thread until Stop returns. The recorder,
+    // if given, gets one replay frame per tick.
+    void Start(SimWorld &world, ReplayRecorder *recorder, const std::string &primaryQuest);
+    void Stop();
+
+    void Submit(const SimInput &input);
+    // Chronicle lines from the render thread, the only producer of posts.
+    // They go through a fixed ring and reach the world chronicle next tick.
+    void Post(std::string_view line);
+    void Postf(const char *format, ...);
+
+    // Newest published snapshot; stays untouched until the next Acquire.
+    const FrameSnapshot &Acquire();
+
+    bool Finished() const { return finished.load(std::memory_order_acquire); }
+    uint32_t Frames() const { return frames; } // valid after Stop
+    float Tick() const { return clock.Tick(); }
+
+private:
+    void Run();
+    void Capture(FrameSnapshot &snapshot, std::chrono::steady_clock::time_point now);
+
+    SimWorld *world = nullptr;
+    ReplayRecorder *recorder = nullptr;
+    const Quest *primaryQuest = nullptr;
+    SimClock clock;
+    uint32_t frames = 0;
+    SimPose previousPose;
+    SimPose currentPose;
+
+    InputQueue inputs;
+    ChronicleQueue posts;
+
+    std::mutex swapMutex;
+    FrameSnapshot buffers[3];
+    uint32_t back = 0;  // sim-owned
+    uint32_t ready = 1; // hand-off slot
+    uint32_t front = 2; // render-owned
+    bool fresh = false;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::atomic<bool> finished{false};
+    std::thread worker;
+};
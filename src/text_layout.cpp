@@ -0,0 +1,278 @@
+#include "text_layout.h"
+
+#include "alloc_counter.h"
+#include "rlgl.h"
+
+#include <algorithm>
+
+// Matches raylib's DrawText: default font, spacing of fontSize / 10 and a
+// two pixel gap between lines.
+static constexpr int kMinFontSize = 10;
+static constexpr float kLineSpacing = 2.0f;
+static constexpr size_t kEvictAbove = 512;
+static constexpr uint32_t kEvictAfterFrames = 120;
+static constexpr uint64_t kPackKey = 1ull << 63; // text hashes keep this bit clear
+
+static uint64_t HashText(std::string_view text)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char c : text)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash & ~kPackKey;
+}
+
+static int DecodeUtf8(std::string_view text, size_t i, size_t &length)
+{
+    const unsigned char c = static_cast<unsigned char>(text[i]);
+    int extra = 0;
+    int codepoint = c;
+    if (c >= 0xF0u)
+    {
+        extra = 3;
+        codepoint = c & 0x07;
+    }
+    else if (c >= 0xE0u)
+    {
+        extra = 2;
+        codepoint = c & 0x0F;
+    }
+    else if (c >= 0xC0u)
+    {
+        extra = 1;
+        codepoint = c & 0x1F;
+    }
+    if (extra > 0 && i + static_cast<size_t>(extra) >= text.size())
+    {
+        length = 1;
+        return '?';
+    }
+    for (int k = 1; k <= extra; ++k)
+    {
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[i + static_cast<size_t>(k)]) & 0x3F);
+    }
+    length = 1u + static_cast<size_t>(extra);
+    return codepoint;
+}
+
+static bool IsBreak(int codepoint)
+{
+    return codepoint == ' ' || codepoint == '\t' || codepoint == '\n';
+}
+
+void TextLayoutCache::Build(std::string_view text, int fontSize, float wrapWidth, TextRun &run)
+{
+    run.quads.clear();
+    run.width = 0.0f;
+    run.height = 0.0f;
+    run.lines = 0;
+    if (font.baseSize <= 0 || font.texture.id == 0)
+    {
+        return;
+    }
+
+    const int size = std::max(fontSize, kMinFontSize);
+    const float scale = static_cast<float>(size) / static_cast<float>(font.baseSize);
+    const float spacing = static_cast<float>(size / kMinFontSize);
+    const float lineHeight = static_cast<float>(size) + kLineSpacing;
+    const float pad = static_cast<float>(font.glyphPadding);
+    const float texW = static_cast<float>(font.texture.width);
+    const float texH = static_cast<float>(font.texture.height);
+
+    const auto advanceOf = [&](int index)
+    {
+        const float advance = font.glyphs[index].advanceX == 0 ? font.recs[index].width : static_cast<float>(font.glyphs[index].advanceX);
+        return advance * scale + spacing;
+    };
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float lineEnd = 0.0f;
+    run.lines = 1;
+    const auto newLine = [&]()
+    {
+        run.width = std::max(run.width, lineEnd);
+        x = 0.0f;
+        lineEnd = 0.0f;
+        y += lineHeight;
+        ++run.lines;
+    };
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        size_t length = 1;
+        const int codepoint = DecodeUtf8(text, i, length);
+        if (codepoint == '\n')
+        {
+            newLine();
+            i += length;
+            continue;
+        }
+        if (codepoint == ' ' || codepoint == '\t')
+        {
+            x += advanceOf(GetGlyphIndex(font, codepoint));
+            i += length;
+            continue;
+        }
+
+        // Measure the whole word first so wrapping happens between words.
+        size_t end = i;
+        float wordWidth = 0.0f;
+        while (end < text.size())
+        {
+            size_t n = 1;
+            const int cp = DecodeUtf8(text, end, n);
+            if (IsBreak(cp))
+            {
+                break;
+            }
+            wordWidth += advanceOf(GetGlyphIndex(font, cp));
+            end += n;
+        }
+        if (wrapWidth > 0.0f && x > 0.0f && x + wordWidth - spacing > wrapWidth)
+        {
+            newLine();
+        }
+
+        while (i < end)
+        {
+            const int cp = DecodeUtf8(text, i, length);
+            const int index = GetGlyphIndex(font, cp);
+            const float advance = advanceOf(index);
+            // Words wider than the wrap width are split between glyphs.
+            if (wrapWidth > 0.0f && x > 0.0f && x + advance - spacing > wrapWidth)
+            {
+                newLine();
+            }
+            const Rectangle rec = font.recs[index];
+            const GlyphInfo &glyph = font.glyphs[index];
+            TextGlyphQuad quad{};
+            quad.x = x + static_cast<float>(glyph.offsetX) * scale - pad * scale;
+            quad.y = y + static_cast<float>(glyph.offsetY) * scale - pad * scale;
+            quad.w = (rec.width + 2.0f * pad) * scale;
+            quad.h = (rec.height + 2.0f * pad) * scale;
+            quad.u0 = (rec.x - pad) / texW;
+            quad.v0 = (rec.y - pad) / texH;
+            quad.u1 = (rec.x + rec.width + pad) / texW;
+            quad.v1 = (rec.y + rec.height + pad) / texH;
+            run.quads.push_back(quad);
+            x += advance;
+            lineEnd = x - spacing;
+            i += length;
+        }
+    }
+    run.width = std::max(run.width, lineEnd);
+    run.height = y + static_cast<float>(size);
+}
+
+void TextLayoutCache::EnsureFont()
+{
+    if (!haveFont)
+    {
+        font = GetFontDefault();
+        haveFont = font.texture.id != 0;
+    }
+}
+
+const TextRun &TextLayoutCache::Layout(std::string_view text, int fontSize, float wrapWidth)
+{
+    EnsureFont();
+    const uint64_t allocationsBefore = HeapAllocations();
+    const Key key{HashText(text), fontSize, wrapWidth};
+    Entry &entry = entries[key];
+    entry.lastUsed = frame;
+    if (entry.run.lines == 0 || entry.text != text)
+    {
+        entry.text.assign(text.data(), text.size());
+        Build(text, fontSize, wrapWidth, entry.run);
+        ++current.layoutsBuilt;
+    }
+    current.allocations += HeapAllocations() - allocationsBefore;
+    return entry.run;
+}
+
+const TextRun &TextLayoutCache::Layout(const ContentPack &content, PackStr text, int fontSize, float wrapWidth)
+{
+    EnsureFont();
+    const uint64_t allocationsBefore = HeapAllocations();
+    const Key key{kPackKey | (static_cast<uint64_t>(text.length) << 32) | text.offset, fontSize, wrapWidth};
+    Entry &entry = entries[key];
+    entry.lastUsed = frame;
+    if (entry.run.lines == 0)
+    {
+        Build(content.Str(text), fontSize, wrapWidth, entry.run);
+        ++current.layoutsBuilt;
+    }
+    current.allocations += HeapAllocations() - allocationsBefore;
+    return entry.run;
+}
+
+void TextLayoutCache::Draw(const TextRun &run, Vector2 position, Color tint)
+{
+    if (run.quads.empty())
+    {
+        return;
+    }
+    current.quads += run.quads.size();
+
+    rlCheckRenderBatchLimit(static_cast<int>(run.quads.size()) * 4);
+    rlSetTexture(font.texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (const TextGlyphQuad &q : run.quads)
+    {
+        const float x0 = position.x + q.x;
+        const float y0 = position.y + q.y;
+        rlTexCoord2f(q.u0, q.v0);
+        rlVertex2f(x0, y0);
+        rlTexCoord2f(q.u0, q.v1);
+        rlVertex2f(x0, y0 + q.h);
+        rlTexCoord2f(q.u1, q.v1);
+        rlVertex2f(x0 + q.w, y0 + q.h);
+        rlTexCoord2f(q.u1, q.v0);
+        rlVertex2f(x0 + q.w, y0);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+Vector2 TextLayoutCache::Draw(std::string_view text, Vector2 position, int fontSize, Color tint, float wrapWidth)
+{
+    const TextRun &run = Layout(text, fontSize, wrapWidth);
+    Draw(run, position, tint);
+    return Vector2{run.width, run.height};
+}
+
+Vector2 TextLayoutCache::Draw(const ContentPack &content, PackStr text, Vector2 position, int fontSize, Color tint, float wrapWidth)
+{
+    const TextRun &run = Layout(content, text, fontSize, wrapWidth);
+    Draw(run, position, tint);
+    return Vector2{run.width, run.height};
+}
+
+void TextLayoutCache::EndFrame()
+{
+    ++frame;
+    current.entries = entries.size();
+    lastFrame = current;
+    current = Stats{};
+    if (entries.size() <= kEvictAbove)
+    {
+        return;
+    }
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (frame - it->second.lastUsed > kEvictAfterFrames)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "content_pack.h"
+#include "raylib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One glyph of a laid-out run, relative to the run origin, with its atlas
+// UVs already normalised.
+struct TextGlyphQuad
+{
+    float x, y, w, h;
+    float u0, v0, u1, v1;
+};
+
+struct TextRun
+{
+    std::vector<TextGlyphQuad> quads;
+    float width = 0.0f;
+    float height = 0.0f;
+    int lines = 0;
+};
+
+// Lays text out with the default font the same way DrawText does, plus
+// optional word wrapping, and keeps the result keyed by (text, size, wrap
+// width). Pack strings are immutable and interned, so they are keyed by
+// their offset with no hashing or compare; other text is keyed by a hash
+// of its bytes and checked against a stored copy.
+class TextLayoutCache
+{
+public:
+    struct Stats
+    {
+        size_t quads = 0;
+        size_t layoutsBuilt = 0;
+        size_t entries = 0;
+        uint64_t allocations = 0; // heap allocations made inside Layout
+    };
+
+    const TextRun &Layout(std::string_view text, int fontSize, float wrapWidth = 0.0f);
+    const TextRun &Layout(const ContentPack &content, PackStr text, int fontSize, float wrapWidth = 0.0f);
+    void Draw(const TextRun &run, Vector2 position, Color tint);
+
+    // Layout + Draw; returns the run size so callers can place trailing text.
+    Vector2 Draw(std::string_view text, Vector2 position, int fontSize, Color tint, float wrapWidth = 0.0f);
+    Vector2 Draw(const ContentPack &content, PackStr text, Vector2 position, int fontSize, Color tint, float wrapWidth = 0.0f);
+
+    // Drops runs unused for a while once the cache grows, and resets stats.
+    void EndFrame();
+    const Stats &LastFrame() const { return lastFrame; }
+
+private:
+    struct Key
+    {
+        uint64_t hash; // text hash, or kPackKey | length | offset for pack strings
+        int fontSize;
+        float wrapWidth;
+        bool operator==(const Key &o) const { return hash == o.hash && fontSize == o.fontSize && wrapWidth == o.wrapWidth; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &k) const { return static_cast<size_t>(k.hash ^ (static_cast<uint64_t>(k.fontSize) << 40)); }
+    };
+
+    struct Entry
+    {
+        std::string text; // only for hashed text
+        TextRun run;
+        uint32_t lastUsed = 0;
+    };
+
+    void Build(std::string_view text, int fontSize, float wrapWidth, TextRun &run);
+    void EnsureFont();
+
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    Font font{};
+    bool haveFont = false;
+    uint32_t frame = 0;
+    Stats current;
+    Stats lastFrame;
+};
@@ -0,0 +1,63 @@
+#include "ui_cache.h"
+
+#include "rlgl.h"
+
+bool LoadCachedPanel(CachedPanel &panel, Rectangle bounds)
+{
+    UnloadCachedPanel(panel);
+    panel.bounds = bounds;
+    panel.target = LoadRenderTexture(static_cast<int>(bounds.width), static_cast<int>(bounds.height));
+    panel.ready = panel.target.id != 0;
+    panel.valid = false;
+    return panel.ready;
+}
+
+void UnloadCachedPanel(CachedPanel &panel)
+{
+    if (panel.ready)
+    {
+        UnloadRenderTexture(panel.target);
+    }
+    panel.target = RenderTexture2D{};
+    panel.ready = false;
+    panel.valid = false;
+}
+
+void InvalidateCachedPanel(CachedPanel &panel)
+{
+    panel.valid = false;
+}
+
+void BeginCachedPanel(CachedPanel &panel)
+{
+    BeginTextureMode(panel.target);
+    ClearBackground(BLANK);
+
+    // Store premultiplied colour with straight coverage in alpha, so the
+    // cached panel composites exactly like drawing it onto the frame.
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+
+    Camera2D camera{};
+    camera.offset = Vector2{-panel.bounds.x, -panel.bounds.y};
+    camera.zoom = 1.0f;
+    BeginMode2D(camera);
+}
+
+void EndCachedPanel(CachedPanel &panel, uint64_t revision)
+{
+    EndMode2D();
+    EndBlendMode();
+    EndTextureMode();
+    panel.revision = revision;
+    panel.valid = true;
+}
+
+void CompositeCachedPanel(const CachedPanel &panel)
+{
+    // Render textures are stored bottom-up; flip on the way out.
+    const Rectangle source{0.0f, 0.0f, panel.bounds.width, -panel.bounds.height};
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTextureRec(panel.target.texture, source, Vector2{panel.bounds.x, panel.bounds.y}, WHITE);
+    EndBlendMode();
+}
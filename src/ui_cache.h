@@ -0,0 +1,52 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstdint>
+
+// A screen-space UI panel kept in its own render texture. The caller passes
+// a revision key derived from the data behind the panel; the panel is only
+// re-rendered when the key changes and is otherwise composited as one quad.
+struct CachedPanel
+{
+    RenderTexture2D target{};
+    Rectangle bounds{};
+    uint64_t revision = 0;
+    bool valid = false; // texture holds the contents for `revision`
+    bool ready = false; // render texture allocated
+};
+
+bool LoadCachedPanel(CachedPanel &panel, Rectangle bounds);
+void UnloadCachedPanel(CachedPanel &panel);
+void InvalidateCachedPanel(CachedPanel &panel);
+
+// Redirects drawing into the panel texture. Draw calls keep using screen
+// coordinates; the panel origin is folded into a 2D camera.
+void BeginCachedPanel(CachedPanel &panel);
+void EndCachedPanel(CachedPanel &panel, uint64_t revision);
+void CompositeCachedPanel(const CachedPanel &panel);
+
+// Draws through the cache when possible, directly otherwise.
+template <typename Fn>
+void DrawCachedPanel(CachedPanel &panel, uint64_t revision, Fn &&draw)
+{
+    if (!panel.ready)
+    {
+        draw();
+        return;
+    }
+    if (!panel.valid || panel.revision != revision)
+    {
+        BeginCachedPanel(panel);
+        draw();
+        EndCachedPanel(panel, revision);
+    }
+    CompositeCachedPanel(panel);
+}
+
+// Order-dependent mix for building revision keys from several fields.
+inline uint64_t MixRevision(uint64_t seed, uint64_t value)
+{
+    seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    return seed;
+}
@@ -0,0 +1,216 @@
+#include "walk_area.h"
+
+#include <algorithm>
+#include <cmath>
+
+static void AppendRing(const std::vector<Vector2> &ring, WalkArea &area)
+{
+    if (ring.size() < 3)
+    {
+        return;
+    }
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    {
+        const Vector2 a = ring[j];
+        const Vector2 b = ring[i];
+        area.edgeX0.push_back(a.x);
+        area.edgeY0.push_back(a.y);
+        area.edgeX1.push_back(b.x);
+        area.edgeY1.push_back(b.y);
+        area.edgeSlope.push_back(a.y != b.y ? (b.x - a.x) / (b.y - a.y) : 0.0f);
+    }
+}
+
+static int CellX(const WalkArea &area, float x)
+{
+    return std::clamp(static_cast<int>((x - area.bounds.x) / area.cellSize), 0, area.cols - 1);
+}
+
+static int CellY(const WalkArea &area, float y)
+{
+    return std::clamp(static_cast<int>((y - area.bounds.y) / area.cellSize), 0, area.rows - 1);
+}
+
+void BuildWalkArea(
+    const std::vector<Vector2> &outline,
+    const std::vector<std::vector<Vector2>> &holes,
+    WalkArea &area)
+{
+    area = WalkArea{};
+    AppendRing(outline, area);
+    for (const auto &hole : holes)
+    {
+        AppendRing(hole, area);
+    }
+
+    const size_t edgeCount = area.edgeX0.size();
+    if (edgeCount == 0)
+    {
+        return;
+    }
+
+    float minX = INFINITY;
+    float minY = INFINITY;
+    float maxX = -INFINITY;
+    float maxY = -INFINITY;
+    for (size_t e = 0; e < edgeCount; ++e)
+    {
+        minX = std::min({minX, area.edgeX0[e], area.edgeX1[e]});
+        minY = std::min({minY, area.edgeY0[e], area.edgeY1[e]});
+        maxX = std::max({maxX, area.edgeX0[e], area.edgeX1[e]});
+        maxY = std::max({maxY, area.edgeY0[e], area.edgeY1[e]});
+    }
+    area.bounds = Rectangle{minX, minY, std::max(maxX - minX, 1.0f), std::max(maxY - minY, 1.0f)};
+
+    // Aim for about one edge per cell, capped so a huge outline cannot blow
+    // up the table.
+    const float targetCells = std::clamp(static_cast<float>(edgeCount), 1.0f, 4096.0f);
+    area.cellSize = std::max(std::sqrt(area.bounds.width * area.bounds.height / targetCells), 8.0f);
+    area.cols = std::max(1, static_cast<int>(std::ceil(area.bounds.width / area.cellSize)));
+    area.rows = std::max(1, static_cast<int>(std::ceil(area.bounds.height / area.cellSize)));
+
+    const size_t cellCount = static_cast<size_t>(area.cols) * static_cast<size_t>(area.rows);
+    std::vector<uint32_t> counts(cellCount, 0u);
+    const auto forEachCell = [&](size_t e, auto &&visit)
+    {
+        const int cx0 = CellX(area, std::min(area.edgeX0[e], area.edgeX1[e]));
+        const int cx1 = CellX(area, std::max(area.edgeX0[e], area.edgeX1[e]));
+        const int cy0 = CellY(area, std::min(area.edgeY0[e], area.edgeY1[e]));
+        const int cy1 = CellY(area, std::max(area.edgeY0[e], area.edgeY1[e]));
+        for (int cy = cy0; cy <= cy1; ++cy)
+        {
+            for (int cx = cx0; cx <= cx1; ++cx)
+            {
+                visit(static_cast<size_t>(cy) * static_cast<size_t>(area.cols) + static_cast<size_t>(cx));
+            }
+        }
+    };
+
+    for (size_t e = 0; e < edgeCount; ++e)
+    {
+        forEachCell(e, [&](size_t cell)
+                    { ++counts[cell]; });
+    }
+    area.cellStart.assign(cellCount + 1, 0u);
+    for (size_t c = 0; c < cellCount; ++c)
+    {
+        area.cellStart[c + 1] = area.cellStart[c] + counts[c];
+    }
+    area.cellEdges.resize(area.cellStart[cellCount]);
+    std::fill(counts.begin(), counts.end(), 0u);
+    for (size_t e = 0; e < edgeCount; ++e)
+    {
+        forEachCell(e, [&](size_t cell)
+                    { area.cellEdges[area.cellStart[cell] + counts[cell]++] = static_cast<uint32_t>(e); });
+    }
+}
+
+bool PointInPolygon(const WalkArea &area, Vector2 p)
+{
+    // Straight-line, branch-free even-odd count over the SoA edge arrays.
+    // Horizontal edges never satisfy the straddle test, so no divide guard.
+    const size_t count = area.edgeX0.size();
+    const float *x0 = area.edgeX0.data();
+    const float *y0 = area.edgeY0.data();
+    const float *y1 = area.edgeY1.data();
+    const float *slope = area.edgeSlope.data();
+
+    unsigned crossings = 0;
+    for (size_t e = 0; e < count; ++e)
+    {
+        const bool straddles = (y0[e] > p.y) != (y1[e] > p.y);
+        const bool left = p.x < x0[e] + (p.y - y0[e]) * slope[e];
+        crossings += static_cast<unsigned>(straddles & left);
+    }
+    return (crossings & 1u) != 0u;
+}
+
+static Vector2 ClosestOnEdge(const WalkArea &area, size_t e, Vector2 p, float &outDistSqr)
+{
+    const float ax = area.edgeX0[e];
+    const float ay = area.edgeY0[e];
+    const float dx = area.edgeX1[e] - ax;
+    const float dy = area.edgeY1[e] - ay;
+    const float lenSqr = dx * dx + dy * dy;
+    const float u = lenSqr > 0.0f ? std::clamp(((p.x - ax) * dx + (p.y - ay) * dy) / lenSqr, 0.0f, 1.0f) : 0.0f;
+    const Vector2 q{ax + dx * u, ay + dy * u};
+    outDistSqr = (q.x - p.x) * (q.x - p.x) + (q.y - p.y) * (q.y - p.y);
+    return q;
+}
+
+Vector2 ClosestBoundaryPoint(const WalkArea &area, Vector2 p)
+{
+    if (area.cellStart.empty())
+    {
+        return p;
+    }
+
+    // Points outside the grid are projected onto it first; distances to any
+    // cell from p are never shorter than from the projection, so the ring
+    // cut-off below stays conservative.
+    const float minX = area.bounds.x;
+    const float minY = area.bounds.y;
+    const Vector2 q{
+        std::clamp(p.x, minX, minX + area.bounds.width),
+        std::clamp(p.y, minY, minY + area.bounds.height)};
+    const int cx = CellX(area, q.x);
+    const int cy = CellY(area, q.y);
+
+    Vector2 best = p;
+    float bestDistSqr = INFINITY;
+    const int maxRing = std::max(area.cols, area.rows);
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        if (ring > 0)
+        {
+            const float innerMinX = minX + static_cast<float>(cx - ring + 1) * area.cellSize;
+            const float innerMinY = minY + static_cast<float>(cy - ring + 1) * area.cellSize;
+            const float innerMaxX = minX + static_cast<float>(cx + ring) * area.cellSize;
+            const float innerMaxY = minY + static_cast<float>(cy + ring) * area.cellSize;
+            const float reach = std::min({q.x - innerMinX, innerMaxX - q.x, q.y - innerMinY, innerMaxY - q.y});
+            if (reach > 0.0f && reach * reach >= bestDistSqr)
+            {
+                break;
+            }
+        }
+
+        for (int y = cy - ring; y <= cy + ring; ++y)
+        {
+            if (y < 0 || y >= area.rows)
+            {
+                continue;
+            }
+            const bool edgeRow = (y == cy - ring || y == cy + ring);
+            const int step = edgeRow ? 1 : std::max(2 * ring, 1);
+            for (int x = cx - ring; x <= cx + ring; x += step)
+            {
+                if (x < 0 || x >= area.cols)
+                {
+                    continue;
+                }
+                const size_t cell = static_cast<size_t>(y) * static_cast<size_t>(area.cols) + static_cast<size_t>(x);
+                for (uint32_t k = area.cellStart[cell]; k < area.cellStart[cell + 1]; ++k)
+                {
+                    float distSqr = 0.0f;
+                    const Vector2 candidate = ClosestOnEdge(area, area.cellEdges[k], p, distSqr);
+                    if (distSqr < bestDistSqr)
+                    {
+                        bestDistSqr = distSqr;
+                        best = candidate;
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+Vector2 ClampToWalkable(const WalkArea &area, Vector2 desired)
+{
+    if (PointInPolygon(area, desired))
+    {
+        return desired;
+    }
+    return ClosestBoundaryPoint(area, desired);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <cstdint>
+#include <vector>
+
+// Walkable region (outline plus holes) stored as structure-of-arrays edges
+// for the even-odd containment test, and bucketed into a uniform grid so
+// nearest-boundary queries only touch edges near the query point.
+struct WalkArea
+{
+    std::vector<float> edgeX0;
+    std::vector<float> edgeY0;
+    std::vector<float> edgeX1;
+    std::vector<float> edgeY1;
+    std::vector<float> edgeSlope; // dx/dy, 0 for horizontal edges
+
+    Rectangle bounds{};
+    float cellSize = 1.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> cellStart; // cols * rows + 1 offsets into cellEdges
+    std::vector<uint32_t> cellEdges;
+};
+
+void BuildWalkArea(
+    const std::vector<Vector2> &outline,
+    const std::vector<std::vector<Vector2>> &holes,
+    WalkArea &area);
+
+bool PointInPolygon(const WalkArea &area, Vector2 p);
+Vector2 ClosestBoundaryPoint(const WalkArea &area, Vector2 p);
+Vector2 ClampToWalkable(const WalkArea &area, Vector2 desired);
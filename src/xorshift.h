@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Marsaglia xorshift32. Cheap and repeatable; used for visuals, benches and
+// tests, never for anything the sim hash sees. The state must not be zero.
+struct XorShift32
+{
+    uint32_t state = 0x9e3779b9u;
+
+    uint32_t Next()
+    {
+        state ^= state << 13u;
+        state ^= state >> 17u;
+        state ^= state << 5u;
+        return state;
+    }
+
+    // Uniform in [0, 1) from the top 24 bits.
+    float Unit() { return static_cast<float>(Next() >> 8u) * (1.0f / 16777216.0f); }
+};
@@ -0,0 +1,1625 @@
+// Compiles the Worldforge text content source into the binary pack that the
+// game maps at startup. Usage: worldforge_pack <source.wfc> <output.pack>
+
+#include "content_pack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct Token
+{
+    std::string text;
+    bool quoted = false;
+};
+
+struct SourceLine
+{
+    size_t number = 0;
+    std::vector<Token> tokens;
+};
+
+class PackBuilder
+{
+public:
+    explicit PackBuilder(std::string sourcePath) : path(std::move(sourcePath))
+    {
+        blob.push_back('\0');
+    }
+
+    bool Parse(const std::string &text);
+    bool Resolve();
+    bool Write(const std::string &outPath) const;
+
+private:
+    struct PendingChoice
+    {
+        PackChoice record{};
+        std::string startQuest;
+        size_t line = 0;
+    };
+
+    struct PendingNode
+    {
+        PackNode record{};
+        std::vector<PendingChoice> choices;
+        size_t line = 0;
+    };
+
+    struct PendingHotspot
+    {
+        PackHotspot record{};
+        std::string transitionTo;
+        std::vector<PackPoint> outline;
+        std::vector<uint32_t> maskBits;
+        size_t line = 0;
+    };
+
+    struct PendingScene
+    {
+        PackScene record{};
+        std::string id;
+        std::vector<PackPoint> walk;
+        std::vector<std::vector<PackPoint>> holes;
+        std::vector<PendingHotspot> hotspots;
+        std::vector<PackLayer> layers;
+        std::vector<PackEmitter> emitters;
+        std::vector<PackImage> images;
+    };
+
+    struct PendingQuest
+    {
+        PackQuest record{};
+        std::string id;
+        std::vector<std::pair<PackObjective, std::vector<uint32_t>>> objectives;
+    };
+
+    bool Fail(size_t line, const std::string &message);
+    PackStr Intern(const std::string &s);
+    uint32_t Flag(const std::string &name);
+    uint32_t ReadFlag(const std::string &name, size_t line); // tested by a condition or objective
+    uint32_t WriteFlag(const std::string &name);             // set by a choice or granted by an event
+    bool ParseScene(const SourceLine &line);
+    bool ParseNode(const SourceLine &line);
+    bool ParseChoice(const SourceLine &line);
+    bool ParseQuest(const SourceLine &line);
+    bool ParseObjective(const SourceLine &line);
+    bool ParseEvent(const SourceLine &line);
+    bool ParseSceneProperty(const SourceLine &line);
+    bool ParseLayer(const SourceLine &line, PendingScene &scene);
+    bool ParseEmitter(const SourceLine &line, PendingScene &scene);
+    bool ParseHotspot(const SourceLine &line, PendingScene &scene);
+    bool LoadMask(const std::string &file, size_t line, PendingHotspot &hotspot);
+    bool ParseCondition(const std::string &expr, size_t line, std::vector<PackCondOp> &cond);
+    bool StoreCondition(const std::vector<PackCondOp> &cond, size_t line, uint32_t &first, uint32_t &count);
+
+    std::string path;
+    bool failed = false;
+
+    std::string blob;
+    std::unordered_map<std::string, PackStr> strings;
+    std::vector<PackStr> flags;
+    std::unordered_map<std::string, uint32_t> flagIds;
+    std::vector<size_t> flagReadAt;   // first line testing each flag, 0 if none
+    std::vector<uint8_t> flagWritten; // some choice sets it or some event grants it
+
+    std::vector<PendingScene> scenes;
+    std::vector<PendingNode> nodes;
+    std::vector<PendingQuest> quests;
+    struct PendingEvent
+    {
+        PackEvent record{};
+        std::string scene;
+        size_t line = 0;
+    };
+    std::vector<PendingEvent> events;
+    std::vector<PackRule> rules;
+    std::vector<PackStr> reasons;
+    std::vector<PackStr> pillars;
+
+    enum class Block
+    {
+        None,
+        Scene,
+        Node,
+        Quest
+    };
+    Block block = Block::None;
+    size_t blockLine = 0;
+
+    std::vector<PackPoint> outPoints;
+    std::vector<PackRing> outRings;
+    std::vector<PackHotspot> outHotspots;
+    std::vector<PackLayer> outLayers;
+    std::vector<PackEmitter> outEmitters;
+    std::vector<PackImage> outImages;
+    std::vector<uint32_t> outMaskBits;
+    std::vector<PackCondOp> outConditions;
+    std::vector<PackScene> outScenes;
+    std::vector<PackNode> outNodes;
+    std::vector<PackChoice> outChoices;
+    std::vector<PackQuest> outQuests;
+    std::vector<PackObjective> outObjectives;
+    std::vector<uint32_t> outObjectiveFlags;
+    std::vector<PackEvent> outEvents;
+};
+
+static bool Tokenize(const std::string &text, size_t number, SourceLine &out, std::string &error)
+{
+    out.number = number;
+    out.tokens.clear();
+    size_t i = 0;
+    while (i < text.size())
+    {
+        const char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            ++i;
+            continue;
+        }
+        if (c == '#')
+        {
+            break;
+        }
+        Token token;
+        if (c == '"')
+        {
+            token.quoted = true;
+            ++i;
+            bool closed = false;
+            while (i < text.size())
+            {
+                const char q = text[i++];
+                if (q == '"')
+                {
+                    closed = true;
+                    break;
+                }
+                if (q == '\\' && i < text.size())
+                {
+                    const char e = text[i++];
+                    token.text.push_back(e == 'n' ? '\n' : e);
+                    continue;
+                }
+                token.text.push_back(q);
+            }
+            if (!closed)
+            {
+                error = "unterminated string";
+                return false;
+            }
+        }
+        else
+        {
+            while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) && text[i] != '"')
+            {
+                token.text.push_back(text[i++]);
+            }
+        }
+        out.tokens.push_back(std::move(token));
+    }
+    return true;
+}
+
+static bool ToInt(const Token &token, int &out)
+{
+    if (token.quoted || token.text.empty())
+    {
+        return false;
+    }
+    char *end = nullptr;
+    const long value = std::strtol(token.text.c_str(), &end, 10);
+    out = static_cast<int>(value);
+    return end != nullptr && *end == '\0';
+}
+
+static bool ToFloat(const Token &token, float &out)
+{
+    if (token.quoted || token.text.empty())
+    {
+        return false;
+    }
+    char *end = nullptr;
+    out = std::strtof(token.text.c_str(), &end);
+    return end != nullptr && *end == '\0';
+}
+
+static bool ReadColor(const std::vector<Token> &t, size_t first, uint8_t *out)
+{
+    for (size_t k = 0; k < 4; ++k)
+    {
+        int v = 0;
+        if (first + k >= t.size() || !ToInt(t[first + k], v) || v < 0 || v > 255)
+        {
+            return false;
+        }
+        out[k] = static_cast<uint8_t>(v);
+    }
+    return true;
+}
+
+// Layer coordinates are either plain numbers or relative to the world
+// extent: "w", "h-190", "w/2+24". axis is 'w' or 'h' for the slot.
+static bool ToCoord(const Token &token, char axis, float &frac, float &px)
+{
+    frac = 0.0f;
+    px = 0.0f;
+    if (token.quoted || token.text.empty())
+    {
+        return false;
+    }
+    const std::string &text = token.text;
+    if (text[0] != 'w' && text[0] != 'h')
+    {
+        return ToFloat(token, px);
+    }
+    if (text[0] != axis)
+    {
+        return false;
+    }
+    size_t pos = 1;
+    frac = 1.0f;
+    if (pos < text.size() && text[pos] == '/')
+    {
+        char *end = nullptr;
+        const long divisor = std::strtol(text.c_str() + pos + 1, &end, 10);
+        if (divisor <= 0 || end == text.c_str() + pos + 1)
+        {
+            return false;
+        }
+        frac = 1.0f / static_cast<float>(divisor);
+        pos = static_cast<size_t>(end - text.c_str());
+    }
+    if (pos == text.size())
+    {
+        return true;
+    }
+    if (text[pos] != '+' && text[pos] != '-')
+    {
+        return false;
+    }
+    char *end = nullptr;
+    px = std::strtof(text.c_str() + pos, &end);
+    return end != nullptr && *end == '\0';
+}
+
+static bool LookupName(const std::string &name, const char *const *names, size_t count, uint8_t &out)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (name == names[i])
+        {
+            out = static_cast<uint8_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Condition expressions, compiled to postfix PackCondOp programs:
+//   expr  := and (('||' | or) and)*
+//   and   := unary (('&&' | and) unary)*
+//   unary := ('!' | not) unary | '(' expr ')' | <stat> <cmp> <int> | <flag>
+// Flag ops come out with arg indexing flagNames; the caller interns them.
+struct ConditionParser
+{
+    const std::string &text;
+    std::vector<PackCondOp> &ops;
+    std::vector<std::string> &flagNames;
+    size_t pos = 0;
+    std::string error;
+
+    std::string Peek(size_t &end) const
+    {
+        size_t i = pos;
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i])))
+        {
+            ++i;
+        }
+        if (i >= text.size())
+        {
+            end = i;
+            return {};
+        }
+        static const char *const symbols[] = {"&&", "||", "<=", ">=", "==", "!=", "!", "(", ")", "<", ">"};
+        for (const char *symbol : symbols)
+        {
+            if (text.compare(i, std::strlen(symbol), symbol) == 0)
+            {
+                end = i + std::strlen(symbol);
+                return symbol;
+            }
+        }
+        size_t j = i;
+        if (text[j] == '-')
+        {
+            ++j;
+        }
+        while (j < text.size() && (std::isalnum(static_cast<unsigned char>(text[j])) || text[j] == '_'))
+        {
+            ++j;
+        }
+        end = j == i ? i + 1 : j;
+        return text.substr(i, end - i);
+    }
+
+    std::string Take()
+    {
+        size_t end = 0;
+        std::string token = Peek(end);
+        pos = end;
+        return token;
+    }
+
+    bool Accept(const char *symbol, const char *word)
+    {
+        size_t end = 0;
+        const std::string token = Peek(end);
+        if (token == symbol || token == word)
+        {
+            pos = end;
+            return true;
+        }
+        return false;
+    }
+
+    void Emit(PackCondOpcode op, uint8_t stat = 0, int32_t arg = 0)
+    {
+        ops.push_back(PackCondOp{static_cast<uint8_t>(op), stat, 0, arg});
+    }
+
+    bool Expr()
+    {
+        if (!And())
+        {
+            return false;
+        }
+        while (Accept("||", "or"))
+        {
+            if (!And())
+            {
+                return false;
+            }
+            Emit(PackCondOpcode::Or);
+        }
+        return true;
+    }
+
+    bool And()
+    {
+        if (!Unary())
+        {
+            return false;
+        }
+        while (Accept("&&", "and"))
+        {
+            if (!Unary())
+            {
+                return false;
+            }
+            Emit(PackCondOpcode::And);
+        }
+        return true;
+    }
+
+    bool Unary()
+    {
+        if (Accept("!", "not"))
+        {
+            if (!Unary())
+            {
+                return false;
+            }
+            Emit(PackCondOpcode::Not);
+            return true;
+        }
+        if (Accept("(", "("))
+        {
+            if (!Expr())
+            {
+                return false;
+            }
+            if (!Accept(")", ")"))
+            {
+                error = "missing ')'";
+                return false;
+            }
+            return true;
+        }
+
+        const std::string name = Take();
+        if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_'))
+        {
+            error = name.empty() ? "unexpected end of condition" : "unexpected '" + name + "'";
+            return false;
+        }
+        static const char *const stats[] = {"composure", "trust", "threat"};
+        static const char *const compares[] = {"<", "<=", ">", ">=", "==", "!="};
+        uint8_t stat = 0;
+        uint8_t compare = 0;
+        size_t end = 0;
+        if (LookupName(name, stats, 3, stat) && LookupName(Peek(end), compares, 6, compare))
+        {
+            pos = end;
+            const std::string value = Take();
+            char *tail = nullptr;
+            const long number = std::strtol(value.c_str(), &tail, 10);
+            if (value.empty() || tail == nullptr || *tail != '\0')
+            {
+                error = "expected a number after '" + name + "'";
+                return false;
+            }
+            Emit(static_cast<PackCondOpcode>(static_cast<uint8_t>(PackCondOpcode::Less) + compare), stat, static_cast<int32_t>(number));
+            return true;
+        }
+        Emit(PackCondOpcode::Flag, 0, static_cast<int32_t>(flagNames.size()));
+        flagNames.push_back(name);
+        return true;
+    }
+};
+
+// Bool stack depth a program needs; the runtime keeps the stack in one word.
+static size_t ConditionDepth(const std::vector<PackCondOp> &ops)
+{
+    size_t depth = 0;
+    size_t deepest = 0;
+    for (const PackCondOp &op : ops)
+    {
+        const auto code = static_cast<PackCondOpcode>(op.op);
+        if (code == PackCondOpcode::And || code == PackCondOpcode::Or)
+        {
+            --depth;
+        }
+        else if (code != PackCondOpcode::Not)
+        {
+            deepest = std::max(deepest, ++depth);
+        }
+    }
+    return deepest;
+}
+
+// ANDs part onto cond, so the requires/blocks/threat shorthands and any
+// number of `when` clauses on one line all have to hold.
+static void AndCondition(std::vector<PackCondOp> &cond, const std::vector<PackCondOp> &part)
+{
+    const bool combine = !cond.empty();
+    cond.insert(cond.end(), part.begin(), part.end());
+    if (combine)
+    {
+        cond.push_back(PackCondOp{static_cast<uint8_t>(PackCondOpcode::And), 0, 0, 0});
+    }
+}
+
+bool PackBuilder::Fail(size_t line, const std::string &message)
+{
+    std::fprintf(stderr, "%s:%zu: error: %s\n", path.c_str(), line, message.c_str());
+    failed = true;
+    return false;
+}
+
+PackStr PackBuilder::Intern(const std::string &s)
+{
+    if (s.empty())
+    {
+        return PackStr{0, 0};
+    }
+    const auto it = strings.find(s);
+    if (it != strings.end())
+    {
+        return it->second;
+    }
+    const PackStr ref{static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(s.size())};
+    blob.append(s);
+    blob.push_back('\0');
+    strings.emplace(s, ref);
+    return ref;
+}
+
+uint32_t PackBuilder::Flag(const std::string &name)
+{
+    if (name.empty())
+    {
+        return kPackNone;
+    }
+    const auto it = flagIds.find(name);
+    if (it != flagIds.end())
+    {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(flags.size());
+    flags.push_back(Intern(name));
+    flagIds.emplace(name, id);
+    flagReadAt.push_back(0);
+    flagWritten.push_back(0);
+    return id;
+}
+
+uint32_t PackBuilder::ReadFlag(const std::string &name, size_t line)
+{
+    const uint32_t id = Flag(name);
+    if (id != kPackNone && flagReadAt[id] == 0)
+    {
+        flagReadAt[id] = line;
+    }
+    return id;
+}
+
+uint32_t PackBuilder::WriteFlag(const std::string &name)
+{
+    const uint32_t id = Flag(name);
+    if (id != kPackNone)
+    {
+        flagWritten[id] = 1;
+    }
+    return id;
+}
+
+bool PackBuilder::ParseCondition(const std::string &expr, size_t line, std::vector<PackCondOp> &cond)
+{
+    std::vector<PackCondOp> ops;
+    std::vector<std::string> names;
+    ConditionParser parser{expr, ops, names, 0, {}};
+    size_t end = 0;
+    if (!parser.Expr())
+    {
+        return Fail(line, "condition \"" + expr + "\": " + parser.error);
+    }
+    const std::string rest = parser.Peek(end);
+    if (!rest.empty())
+    {
+        return Fail(line, "condition \"" + expr + "\": unexpected '" + rest + "'");
+    }
+    for (PackCondOp &op : ops)
+    {
+        if (static_cast<PackCondOpcode>(op.op) == PackCondOpcode::Flag)
+        {
+            op.arg = static_cast<int32_t>(ReadFlag(names[static_cast<size_t>(op.arg)], line));
+        }
+    }
+    AndCondition(cond, ops);
+    return true;
+}
+
+bool PackBuilder::StoreCondition(const std::vector<PackCondOp> &cond, size_t line, uint32_t &first, uint32_t &count)
+{
+    if (ConditionDepth(cond) > kPackConditionDepth)
+    {
+        return Fail(line, "condition nests too deeply");
+    }
+    first = static_cast<uint32_t>(outConditions.size());
+    count = static_cast<uint32_t>(cond.size());
+    outConditions.insert(outConditions.end(), cond.begin(), cond.end());
+    return true;
+}
+
+bool PackBuilder::ParseScene(const SourceLine &line)
+{
+    if (line.tokens.size() != 2)
+    {
+        return Fail(line.number, "expected: scene <id>");
+    }
+    PendingScene scene;
+    scene.id = line.tokens[1].text;
+    scene.record.id = Intern(scene.id);
+    scene.record.cameraOffsetNorm[0] = 0.5f;
+    scene.record.cameraOffsetNorm[1] = 0.5f;
+    scene.record.cameraZoom = 0.62f;
+    scene.record.post = PackPostFx{0.06f, 0.08f, 0.5f, 1.0f, 1.0f, 1.0f, {0, 0, 0, 0}, {255, 255, 255, 0}};
+    scene.record.ambientBeat = 8.0f;
+    scenes.push_back(std::move(scene));
+    block = Block::Scene;
+    return true;
+}
+
+bool PackBuilder::ParseSceneProperty(const SourceLine &line)
+{
+    PendingScene &scene = scenes.back();
+    const std::vector<Token> &t = line.tokens;
+    const std::string &key = t[0].text;
+
+    const auto readPoints = [&](std::vector<PackPoint> &out)
+    {
+        if (t.size() < 7 || (t.size() - 1) % 2 != 0)
+        {
+            return false;
+        }
+        for (size_t k = 1; k + 1 < t.size(); k += 2)
+        {
+            PackPoint p{};
+            if (!ToFloat(t[k], p.x) || !ToFloat(t[k + 1], p.y))
+            {
+                return false;
+            }
+            out.push_back(p);
+        }
+        return true;
+    };
+
+    if (key == "colors")
+    {
+        if (t.size() != 9 || !ReadColor(t, 1, scene.record.topColor) || !ReadColor(t, 5, scene.record.bottomColor))
+        {
+            return Fail(line.number, "expected: colors <r g b a> <r g b a>");
+        }
+        return true;
+    }
+    if (key == "camera")
+    {
+        if (t.size() != 6 ||
+            !ToFloat(t[1], scene.record.cameraTarget[0]) || !ToFloat(t[2], scene.record.cameraTarget[1]) ||
+            !ToFloat(t[3], scene.record.cameraOffsetNorm[0]) || !ToFloat(t[4], scene.record.cameraOffsetNorm[1]) ||
+            !ToFloat(t[5], scene.record.cameraZoom))
+        {
+            return Fail(line.number, "expected: camera <targetX> <targetY> <offsetX> <offsetY> <zoom>");
+        }
+        return true;
+    }
+    if (key == "walk")
+    {
+        scene.walk.clear();
+        if (!readPoints(scene.walk))
+        {
+            return Fail(line.number, "expected: walk <x y> x3 or more");
+        }
+        return true;
+    }
+    if (key == "hole")
+    {
+        std::vector<PackPoint> hole;
+        if (!readPoints(hole))
+        {
+            return Fail(line.number, "expected: hole <x y> x3 or more");
+        }
+        scene.holes.push_back(std::move(hole));
+        return true;
+    }
+    if (key == "hotspot")
+    {
+        return ParseHotspot(line, scene);
+    }
+    if (key == "layer")
+    {
+        return ParseLayer(line, scene);
+    }
+    if (key == "emitter")
+    {
+        return ParseEmitter(line, scene);
+    }
+    if (key == "image")
+    {
+        static const char *const passes[] = {"backdrop", "light", "foreground"};
+        PackImage image{};
+        image.frac[2] = 1.0f;
+        image.frac[3] = 1.0f;
+        if ((t.size() != 3 && t.size() != 7) || !LookupName(t[1].text, passes, 3, image.pass) ||
+            static_cast<PackLayerPass>(image.pass) == PackLayerPass::Light || !t[2].quoted ||
+            t[2].text.empty() ||
+            (t.size() == 7 && (!ToCoord(t[3], 'w', image.frac[0], image.px[0]) || !ToCoord(t[4], 'h', image.frac[1], image.px[1]) ||
+                               !ToCoord(t[5], 'w', image.frac[2], image.px[2]) || !ToCoord(t[6], 'h', image.frac[3], image.px[3]))))
+        {
+            return Fail(line.number, "expected: image backdrop|foreground \"<path>\" [<x y w h>]");
+        }
+        image.path = Intern(t[2].text);
+        scene.images.push_back(image);
+        return true;
+    }
+    if (key == "post")
+    {
+        PackPostFx &post = scene.record.post;
+        for (size_t k = 1; k < t.size(); k += 2)
+        {
+            const std::string &option = t[k].text;
+            float *value = option == "grain"        ? &post.grain
+                           : option == "scanlines"  ? &post.scanlines
+                           : option == "vignette"   ? &post.vignette
+                           : option == "aberration" ? &post.aberration
+                                                    : nullptr;
+            if (value == nullptr || k + 1 >= t.size() || !ToFloat(t[k + 1], *value) || *value < 0.0f)
+            {
+                return Fail(line.number, "expected: post [grain <g>] [scanlines <s>] [vignette <v>] [aberration <px>]");
+            }
+        }
+        return true;
+    }
+    if (key == "grade")
+    {
+        PackPostFx &post = scene.record.post;
+        size_t k = 1;
+        while (k < t.size())
+        {
+            const std::string &option = t[k].text;
+            if (option == "saturation" && k + 1 < t.size() && ToFloat(t[k + 1], post.saturation) && post.saturation >= 0.0f)
+            {
+                k += 2;
+            }
+            else if (option == "contrast" && k + 1 < t.size() && ToFloat(t[k + 1], post.contrast) && post.contrast >= 0.0f)
+            {
+                k += 2;
+            }
+            else if (option == "shadows" && ReadColor(t, k + 1, post.shadowTint))
+            {
+                k += 5;
+            }
+            else if (option == "highlights" && ReadColor(t, k + 1, post.highlightTint))
+            {
+                k += 5;
+            }
+            else
+            {
+                return Fail(line.number, "expected: grade [saturation <s>] [contrast <c>] [shadows <r g b a>] [highlights <r g b a>]");
+            }
+        }
+        return true;
+    }
+    if (key == "ambient")
+    {
+        PackScene &record = scene.record;
+        if ((t.size() != 2 && t.size() != 4) || !ToFloat(t[1], record.ambientBeat) || record.ambientBeat <= 0.0f ||
+            (t.size() == 4 && (t[2].text != "jitter" || !ToFloat(t[3], record.ambientJitter) || record.ambientJitter < 0.0f)))
+        {
+            return Fail(line.number, "expected: ambient <beat seconds> [jitter <seconds>]");
+        }
+        return true;
+    }
+    if (key == "flavor" || key == "art")
+    {
+        if (t.size() != 2 || !t[1].quoted)
+        {
+            return Fail(line.number, "expected: " + key + " \"<text>\"");
+        }
+        (key == "flavor" ? scene.record.flavorText : scene.record.artDirection) = Intern(t[1].text);
+        return true;
+    }
+    return Fail(line.number, "unknown scene property '" + key + "'");
+}
+
+bool PackBuilder::ParseHotspot(const SourceLine &line, PendingScene &scene)
+{
+    const std::vector<Token> &t = line.tokens;
+    PendingHotspot hotspot;
+    hotspot.line = line.number;
+    hotspot.record.dialogueNode = -1;
+    if (t.size() < 8 || !t[1].quoted ||
+        !ToFloat(t[2], hotspot.record.area[0]) || !ToFloat(t[3], hotspot.record.area[1]) ||
+        !ToFloat(t[4], hotspot.record.area[2]) || !ToFloat(t[5], hotspot.record.area[3]))
+    {
+        return Fail(line.number, "expected: hotspot \"<label>\" <x> <y> <w> <h> dialogue <node> | exit <scene> <x> <y>");
+    }
+    hotspot.record.label = Intern(t[1].text);
+    int node = -1;
+    size_t k = 0;
+    if (t[6].text == "dialogue" && ToInt(t[7], node))
+    {
+        hotspot.record.dialogueNode = node;
+        k = 8;
+    }
+    else if (t[6].text == "exit" && t.size() >= 10 &&
+             ToFloat(t[8], hotspot.record.spawn[0]) && ToFloat(t[9], hotspot.record.spawn[1]))
+    {
+        hotspot.transitionTo = t[7].text;
+        hotspot.record.transitionTo = Intern(hotspot.transitionTo);
+        k = 10;
+    }
+    else
+    {
+        return Fail(line.number, "hotspot needs 'dialogue <node>' or 'exit <scene> <x> <y>'");
+    }
+
+    while (k < t.size())
+    {
+        const std::string &option = t[k].text;
+        int z = 0;
+        if (option == "z" && k + 1 < t.size() && ToInt(t[k + 1], z))
+        {
+            hotspot.record.z = z;
+            k += 2;
+        }
+        else if (option == "mask" && k + 1 < t.size() && t[k + 1].quoted)
+        {
+            if (!LoadMask(t[k + 1].text, line.number, hotspot))
+            {
+                return false;
+            }
+            k += 2;
+        }
+        else if (option == "outline")
+        {
+            // Takes the rest of the line.
+            if ((t.size() - k - 1) < 6 || (t.size() - k - 1) % 2 != 0)
+            {
+                return Fail(line.number, "hotspot outline needs 3 or more <x y> points");
+            }
+            for (++k; k + 1 < t.size(); k += 2)
+            {
+                PackPoint p{};
+                if (!ToFloat(t[k], p.x) || !ToFloat(t[k + 1], p.y))
+                {
+                    return Fail(line.number, "bad hotspot outline point");
+                }
+                hotspot.outline.push_back(p);
+            }
+        }
+        else
+        {
+            return Fail(line.number, "bad hotspot option '" + option + "' (z <n>, mask \"<file.pgm>\", outline <x y>...)");
+        }
+    }
+    scene.hotspots.push_back(std::move(hotspot));
+    return true;
+}
+
+// Reads a binary (P5) or plain (P2) PGM next to the source file; gray >= half
+// of maxval is solid. The mask is stretched over the hotspot rectangle.
+bool PackBuilder::LoadMask(const std::string &file, size_t line, PendingHotspot &hotspot)
+{
+    const size_t slash = path.find_last_of("/\\");
+    const std::string full = (slash == std::string::npos ? std::string() : path.substr(0, slash + 1)) + file;
+    std::ifstream in(full, std::ios::binary);
+    std::string magic;
+    int width = 0;
+    int height = 0;
+    int maxValue = 0;
+    const auto skipComments = [&]()
+    {
+        in >> std::ws;
+        while (in.peek() == '#')
+        {
+            std::string comment;
+            std::getline(in, comment);
+            in >> std::ws;
+        }
+    };
+    in >> magic;
+    skipComments();
+    in >> width;
+    skipComments();
+    in >> height;
+    skipComments();
+    in >> maxValue;
+    if (!in || (magic != "P5" && magic != "P2") || width <= 0 || height <= 0 || width > 4096 || height > 4096 ||
+        maxValue <= 0 || maxValue > 255)
+    {
+        return Fail(line, "cannot read 8-bit PGM mask '" + full + "'");
+    }
+    in.get(); // single whitespace before binary data
+
+    const size_t words = (static_cast<size_t>(width) * static_cast<size_t>(height) + 31u) / 32u;
+    hotspot.maskBits.assign(words, 0u);
+    for (size_t i = 0; i < static_cast<size_t>(width) * static_cast<size_t>(height); ++i)
+    {
+        int value = 0;
+        if (magic == "P5")
+        {
+            value = in.get();
+        }
+        else
+        {
+            in >> value;
+        }
+        if (!in)
+        {
+            return Fail(line, "PGM mask '" + full + "' is truncated");
+        }
+        if (value * 2 >= maxValue)
+        {
+            hotspot.maskBits[i / 32u] |= 1u << (i % 32u);
+        }
+    }
+    hotspot.record.maskWidth = static_cast<uint16_t>(width);
+    hotspot.record.maskHeight = static_cast<uint16_t>(height);
+    return true;
+}
+
+bool PackBuilder::ParseLayer(const SourceLine &line, PendingScene &scene)
+{
+    static const char *const passes[] = {"backdrop", "light", "foreground"};
+    static const char *const kinds[] = {"rect", "frame", "glow", "line"};
+    static const char *const waves[] = {"none", "x", "y", "size", "alpha"};
+    static_assert(sizeof(passes) / sizeof(passes[0]) == static_cast<size_t>(PackLayerPass::Count), "layer pass names");
+
+    const std::vector<Token> &t = line.tokens;
+    PackLayer layer{};
+    layer.repeatCount = 1;
+    layer.thickness = 1.0f;
+    if (t.size() < 3 || !LookupName(t[1].text, passes, 3, layer.pass))
+    {
+        return Fail(line.number, "expected: layer backdrop|light|foreground <kind> ...");
+    }
+    if (!LookupName(t[2].text, kinds, 4, layer.kind))
+    {
+        return Fail(line.number, "unknown layer kind '" + t[2].text + "'");
+    }
+
+    size_t k = 3;
+    const size_t slots = static_cast<PackLayerKind>(layer.kind) == PackLayerKind::Glow ? 3 : 4;
+    for (size_t s = 0; s < slots; ++s, ++k)
+    {
+        if (k >= t.size() || !ToCoord(t[k], s % 2 == 0 ? 'w' : 'h', layer.frac[s], layer.px[s]))
+        {
+            return Fail(line.number, "layer " + t[2].text + " needs " + std::to_string(slots) +
+                                         " coordinates (<n>, w, w-<n>, w/<d>+<n>, h...)");
+        }
+    }
+
+    bool hasColor = false;
+    while (k < t.size())
+    {
+        const std::string &option = t[k].text;
+        const size_t left = t.size() - k - 1;
+        int count = 0;
+        if (option == "color" && ReadColor(t, k + 1, layer.color))
+        {
+            hasColor = true;
+            k += 5;
+        }
+        else if (option == "thick" && left >= 1 && ToFloat(t[k + 1], layer.thickness))
+        {
+            k += 2;
+        }
+        else if (option == "wave" && left >= 3 && LookupName(t[k + 1].text, waves, 5, layer.wave) && layer.wave != 0 &&
+                 ToFloat(t[k + 2], layer.waveAmp) && ToFloat(t[k + 3], layer.waveFreq))
+        {
+            k += 4;
+        }
+        else if (option == "phase" && left >= 1 && ToFloat(t[k + 1], layer.wavePhaseStep))
+        {
+            k += 2;
+        }
+        else if (option == "repeat" && left >= 3 && ToInt(t[k + 1], count) && count > 0 &&
+                 ToFloat(t[k + 2], layer.repeatStep[0]) && ToFloat(t[k + 3], layer.repeatStep[1]))
+        {
+            layer.repeatCount = static_cast<uint32_t>(count);
+            k += 4;
+        }
+        else if (option == "from" && left >= 1 && ToInt(t[k + 1], count))
+        {
+            layer.repeatFirst = count;
+            k += 2;
+        }
+        else if (option == "scroll" && left >= 2 && ToFloat(t[k + 1], layer.scrollSpeed) &&
+                 ToFloat(t[k + 2], layer.scrollPeriod) && layer.scrollPeriod > 0.0f)
+        {
+            k += 3;
+        }
+        else
+        {
+            return Fail(line.number, "bad layer option '" + option + "'");
+        }
+    }
+    if (!hasColor)
+    {
+        return Fail(line.number, "layer needs 'color <r g b a>'");
+    }
+    scene.layers.push_back(layer);
+    return true;
+}
+
+bool PackBuilder::ParseEmitter(const SourceLine &line, PendingScene &scene)
+{
+    const std::vector<Token> &t = line.tokens;
+    PackEmitter emitter{};
+    emitter.areaFrac[2] = 1.0f;
+    emitter.areaFrac[3] = 1.0f;
+    emitter.life[0] = 4.0f;
+    emitter.life[1] = 8.0f;
+    emitter.seed = static_cast<uint32_t>(scene.emitters.size() + 1u) * 2654435761u;
+    int budget = 0;
+    if (t.size() < 3 || !ToInt(t[1], budget) || budget <= 0 || !ToFloat(t[2], emitter.size) || emitter.size <= 0.0f)
+    {
+        return Fail(line.number, "expected: emitter <budget> <size> color <r g b a> [options]");
+    }
+    emitter.budget = static_cast<uint32_t>(budget);
+
+    bool hasColor = false;
+    size_t k = 3;
+    while (k < t.size())
+    {
+        const std::string &option = t[k].text;
+        const size_t left = t.size() - k - 1;
+        int seed = 0;
+        if (option == "color" && ReadColor(t, k + 1, emitter.color))
+        {
+            hasColor = true;
+            k += 5;
+        }
+        else if (option == "area" && left >= 4 &&
+                 ToCoord(t[k + 1], 'w', emitter.areaFrac[0], emitter.areaPx[0]) &&
+                 ToCoord(t[k + 2], 'h', emitter.areaFrac[1], emitter.areaPx[1]) &&
+                 ToCoord(t[k + 3], 'w', emitter.areaFrac[2], emitter.areaPx[2]) &&
+                 ToCoord(t[k + 4], 'h', emitter.areaFrac[3], emitter.areaPx[3]))
+        {
+            k += 5;
+        }
+        else if (option == "drift" && left >= 2 && ToFloat(t[k + 1], emitter.drift[0]) && ToFloat(t[k + 2], emitter.drift[1]))
+        {
+            k += 3;
+        }
+        else if (option == "jitter" && left >= 2 && ToFloat(t[k + 1], emitter.jitter[0]) && ToFloat(t[k + 2], emitter.jitter[1]))
+        {
+            k += 3;
+        }
+        else if (option == "life" && left >= 2 && ToFloat(t[k + 1], emitter.life[0]) && ToFloat(t[k + 2], emitter.life[1]) &&
+                 emitter.life[0] > 0.0f && emitter.life[1] >= emitter.life[0])
+        {
+            k += 3;
+        }
+        else if (option == "seed" && left >= 1 && ToInt(t[k + 1], seed))
+        {
+            emitter.seed = static_cast<uint32_t>(seed);
+            k += 2;
+        }
+        else
+        {
+            return Fail(line.number, "bad emitter option '" + option + "'");
+        }
+    }
+    if (!hasColor)
+    {
+        return Fail(line.number, "emitter needs 'color <r g b a>'");
+    }
+    scene.emitters.push_back(emitter);
+    return true;
+}
+
+bool PackBuilder::ParseNode(const SourceLine &line)
+{
+    int id = 0;
+    if (line.tokens.size() != 4 || !ToInt(line.tokens[1], id) || !line.tokens[2].quoted || !line.tokens[3].quoted)
+    {
+        return Fail(line.number, "expected: node <id> \"<speaker>\" \"<line>\"");
+    }
+    PendingNode node;
+    node.line = line.number;
+    node.record.id = id;
+    node.record.speaker = Intern(line.tokens[2].text);
+    node.record.line = Intern(line.tokens[3].text);
+    nodes.push_back(std::move(node));
+    block = Block::Node;
+    return true;
+}
+
+bool PackBuilder::ParseChoice(const SourceLine &line)
+{
+    const std::vector<Token> &t = line.tokens;
+    if (t.size() < 2 || !t[1].quoted)
+    {
+        return Fail(line.number, "expected: choice \"<text>\" [options]");
+    }
+
+    PendingChoice choice;
+    choice.line = line.number;
+    choice.record.text = Intern(t[1].text);
+    choice.record.nextNode = -1;
+    choice.record.setFlag = kPackNone;
+    std::vector<PackCondOp> cond;
+
+    for (size_t i = 2; i < t.size();)
+    {
+        const std::string &key = t[i].text;
+        const auto need = [&](size_t n)
+        {
+            return i + n < t.size();
+        };
+        if (key == "next" && need(1) && ToInt(t[i + 1], choice.record.nextNode))
+        {
+            i += 2;
+        }
+        else if (key == "set" && need(1))
+        {
+            choice.record.setFlag = WriteFlag(t[i + 1].text);
+            i += 2;
+        }
+        else if ((key == "requires" || key == "blocks") && need(1))
+        {
+            std::vector<PackCondOp> part{PackCondOp{static_cast<uint8_t>(PackCondOpcode::Flag), 0, 0, static_cast<int32_t>(ReadFlag(t[i + 1].text, line.number))}};
+            if (key == "blocks")
+            {
+                part.push_back(PackCondOp{static_cast<uint8_t>(PackCondOpcode::Not), 0, 0, 0});
+            }
+            AndCondition(cond, part);
+            i += 2;
+        }
+        else if (key == "when" && need(1) && t[i + 1].quoted)
+        {
+            if (!ParseCondition(t[i + 1].text, line.number, cond))
+            {
+                return false;
+            }
+            i += 2;
+        }
+        else if (key == "quest" && need(1))
+        {
+            choice.startQuest = t[i + 1].text;
+            choice.record.startQuest = Intern(choice.startQuest);
+            i += 2;
+        }
+        else if (key == "impact" && need(3))
+        {
+            int c = 0;
+            int tr = 0;
+            int th = 0;
+            if (!ToInt(t[i + 1], c) || !ToInt(t[i + 2], tr) || !ToInt(t[i + 3], th))
+            {
+                return Fail(line.number, "expected: impact <composure> <trust> <threat>");
+            }
+            choice.record.composureDelta = c;
+            choice.record.crewTrustDelta = tr;
+            choice.record.threatDelta = th;
+            i += 4;
+        }
+        else if (key == "log" && need(1) && t[i + 1].quoted)
+        {
+            choice.record.consequenceLine = Intern(t[i + 1].text);
+            i += 2;
+        }
+        else
+        {
+            return Fail(line.number, "bad choice option '" + key + "'");
+        }
+    }
+    if (!StoreCondition(cond, line.number, choice.record.condFirst, choice.record.condCount))
+    {
+        return false;
+    }
+
+    nodes.back().choices.push_back(std::move(choice));
+    return true;
+}
+
+bool PackBuilder::ParseQuest(const SourceLine &line)
+{
+    const std::vector<Token> &t = line.tokens;
+    if (t.size() != 4 || !t[2].quoted || !t[3].quoted)
+    {
+        return Fail(line.number, "expected: quest <id> \"<title>\" \"<purpose>\"");
+    }
+    PendingQuest quest;
+    quest.id = t[1].text;
+    quest.record.id = Intern(quest.id);
+    quest.record.title = Intern(t[2].text);
+    quest.record.purpose = Intern(t[3].text);
+    quests.push_back(std::move(quest));
+    block = Block::Quest;
+    return true;
+}
+
+bool PackBuilder::ParseObjective(const SourceLine &line)
+{
+    const std::vector<Token> &t = line.tokens;
+    if (t.size() < 3 || !t[1].quoted)
+    {
+        return Fail(line.number, "expected: objective \"<text>\" <flag> [flag...]");
+    }
+    PackObjective objective{};
+    objective.text = Intern(t[1].text);
+    std::vector<uint32_t> doneBy;
+    for (size_t i = 2; i < t.size(); ++i)
+    {
+        doneBy.push_back(ReadFlag(t[i].text, line.number));
+    }
+    quests.back().objectives.emplace_back(objective, std::move(doneBy));
+    return true;
+}
+
+bool PackBuilder::ParseEvent(const SourceLine &line)
+{
+    const std::vector<Token> &t = line.tokens;
+    if (t.size() < 3 || !t[2].quoted)
+    {
+        return Fail(line.number, "expected: event <id> \"<line>\" [options]");
+    }
+    PendingEvent pending;
+    pending.line = line.number;
+    PackEvent &event = pending.record;
+    event.id = Intern(t[1].text);
+    event.line = Intern(t[2].text);
+    event.grantsFlag = kPackNone;
+    event.fireOnce = 1;
+    std::vector<PackCondOp> cond;
+    int minThreat = 0;
+    for (size_t i = 3; i < t.size();)
+    {
+        const std::string &key = t[i].text;
+        if (key == "grants" && i + 1 < t.size())
+        {
+            event.grantsFlag = WriteFlag(t[i + 1].text);
+            i += 2;
+        }
+        else if (key == "requires" && i + 1 < t.size())
+        {
+            AndCondition(cond, {PackCondOp{static_cast<uint8_t>(PackCondOpcode::Flag), 0, 0, static_cast<int32_t>(ReadFlag(t[i + 1].text, line.number))}});
+            i += 2;
+        }
+        else if (key == "threat" && i + 1 < t.size() && ToInt(t[i + 1], minThreat))
+        {
+            AndCondition(cond, {PackCondOp{static_cast<uint8_t>(PackCondOpcode::GreaterEqual), static_cast<uint8_t>(PackStat::Threat), 0, minThreat}});
+            i += 2;
+        }
+        else if (key == "when" && i + 1 < t.size() && t[i + 1].quoted)
+        {
+            if (!ParseCondition(t[i + 1].text, line.number, cond))
+            {
+                return false;
+            }
+            i += 2;
+        }
+        else if (key == "priority" && i + 1 < t.size() && ToInt(t[i + 1], event.priority))
+        {
+            i += 2;
+        }
+        else if (key == "cooldown" && i + 1 < t.size() && ToFloat(t[i + 1], event.cooldown) && event.cooldown >= 0.0f)
+        {
+            i += 2;
+        }
+        else if (key == "jitter" && i + 1 < t.size() && ToFloat(t[i + 1], event.jitter) && event.jitter >= 0.0f)
+        {
+            i += 2;
+        }
+        else if (key == "scene" && i + 1 < t.size())
+        {
+            pending.scene = t[i + 1].text;
+            event.scene = Intern(pending.scene);
+            i += 2;
+        }
+        else if (key == "repeat")
+        {
+            event.fireOnce = 0;
+            ++i;
+        }
+        else
+        {
+            return Fail(line.number, "bad event option '" + key + "'");
+        }
+    }
+    if (!StoreCondition(cond, line.number, event.condFirst, event.condCount))
+    {
+        return false;
+    }
+    events.push_back(std::move(pending));
+    return true;
+}
+
+bool PackBuilder::Parse(const std::string &text)
+{
+    std::istringstream in(text);
+    std::string raw;
+    size_t number = 0;
+    SourceLine line;
+    while (std::getline(in, raw))
+    {
+        ++number;
+        std::string error;
+        if (!Tokenize(raw, number, line, error))
+        {
+            Fail(number, error);
+            continue;
+        }
+        if (line.tokens.empty())
+        {
+            continue;
+        }
+
+        const std::string &key = line.tokens[0].text;
+        if (key == "end")
+        {
+            if (block == Block::None)
+            {
+                Fail(number, "'end' without an open block");
+            }
+            block = Block::None;
+            continue;
+        }
+
+        if (block == Block::Scene)
+        {
+            ParseSceneProperty(line);
+            continue;
+        }
+        if (block == Block::Node)
+        {
+            if (key == "choice")
+            {
+                ParseChoice(line);
+            }
+            else
+            {
+                Fail(number, "only 'choice' lines may appear inside a node");
+            }
+            continue;
+        }
+        if (block == Block::Quest)
+        {
+            if (key == "objective")
+            {
+                ParseObjective(line);
+            }
+            else
+            {
+                Fail(number, "only 'objective' lines may appear inside a quest");
+            }
+            continue;
+        }
+
+        blockLine = number;
+        if (key == "scene")
+        {
+            ParseScene(line);
+        }
+        else if (key == "node")
+        {
+            ParseNode(line);
+        }
+        else if (key == "quest")
+        {
+            ParseQuest(line);
+        }
+        else if (key == "event")
+        {
+            ParseEvent(line);
+        }
+        else if (key == "flag" && line.tokens.size() == 2)
+        {
+            Flag(line.tokens[1].text);
+        }
+        else if (key == "reason" && line.tokens.size() == 2 && line.tokens[1].quoted)
+        {
+            reasons.push_back(Intern(line.tokens[1].text));
+        }
+        else if (key == "pillar" && line.tokens.size() == 2 && line.tokens[1].quoted)
+        {
+            pillars.push_back(Intern(line.tokens[1].text));
+        }
+        else if (key == "rule" && line.tokens.size() == 3 && line.tokens[2].quoted)
+        {
+            rules.push_back(PackRule{Intern(line.tokens[1].text), Intern(line.tokens[2].text)});
+        }
+        else
+        {
+            Fail(number, "unknown directive '" + key + "'");
+        }
+    }
+    if (block != Block::None)
+    {
+        Fail(blockLine, "block is missing 'end'");
+    }
+    return !failed;
+}
+
+bool PackBuilder::Resolve()
+{
+    std::unordered_set<std::string> sceneIds;
+    for (const auto &scene : scenes)
+    {
+        if (!sceneIds.insert(scene.id).second)
+        {
+            Fail(0, "duplicate scene '" + scene.id + "'");
+        }
+    }
+    // Source files refer to nodes by authored id; the pack stores dense
+    // indices into the sorted node table so the runtime never searches.
+    std::sort(nodes.begin(), nodes.end(), [](const PendingNode &a, const PendingNode &b)
+              { return a.record.id < b.record.id; });
+    std::unordered_map<int, int32_t> nodeIndex;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        if (!nodeIndex.emplace(nodes[i].record.id, static_cast<int32_t>(i)).second)
+        {
+            Fail(nodes[i].line, "duplicate node " + std::to_string(nodes[i].record.id));
+        }
+    }
+    const auto resolveNode = [&](int32_t &node, size_t line, const char *what)
+    {
+        if (node < 0)
+        {
+            return;
+        }
+        const auto it = nodeIndex.find(node);
+        if (it == nodeIndex.end())
+        {
+            Fail(line, std::string(what) + " unknown node " + std::to_string(node));
+            node = -1;
+            return;
+        }
+        node = it->second;
+    };
+    std::unordered_set<std::string> questIds;
+    for (const auto &quest : quests)
+    {
+        questIds.insert(quest.id);
+    }
+
+    for (auto &scene : scenes)
+    {
+        if (scene.walk.size() < 3)
+        {
+            Fail(0, "scene '" + scene.id + "' has no walk polygon");
+        }
+        scene.record.walk = PackRing{static_cast<uint32_t>(outPoints.size()), static_cast<uint32_t>(scene.walk.size())};
+        outPoints.insert(outPoints.end(), scene.walk.begin(), scene.walk.end());
+
+        scene.record.holeFirst = static_cast<uint32_t>(outRings.size());
+        scene.record.holeCount = static_cast<uint32_t>(scene.holes.size());
+        for (const auto &hole : scene.holes)
+        {
+            outRings.push_back(PackRing{static_cast<uint32_t>(outPoints.size()), static_cast<uint32_t>(hole.size())});
+            outPoints.insert(outPoints.end(), hole.begin(), hole.end());
+        }
+
+        scene.record.hotspotFirst = static_cast<uint32_t>(outHotspots.size());
+        scene.record.hotspotCount = static_cast<uint32_t>(scene.hotspots.size());
+        for (auto &hotspot : scene.hotspots)
+        {
+            if (!hotspot.transitionTo.empty() && sceneIds.count(hotspot.transitionTo) == 0)
+            {
+                Fail(hotspot.line, "exit targets unknown scene '" + hotspot.transitionTo + "'");
+            }
+            resolveNode(hotspot.record.dialogueNode, hotspot.line, "hotspot opens");
+            hotspot.record.outline = PackRing{static_cast<uint32_t>(outPoints.size()), static_cast<uint32_t>(hotspot.outline.size())};
+            outPoints.insert(outPoints.end(), hotspot.outline.begin(), hotspot.outline.end());
+            hotspot.record.maskFirst = static_cast<uint32_t>(outMaskBits.size());
+            outMaskBits.insert(outMaskBits.end(), hotspot.maskBits.begin(), hotspot.maskBits.end());
+            outHotspots.push_back(hotspot.record);
+        }
+        // Layers keep their authored order; the runtime groups them by pass.
+        scene.record.layerFirst = static_cast<uint32_t>(outLayers.size());
+        scene.record.layerCount = static_cast<uint32_t>(scene.layers.size());
+        outLayers.insert(outLayers.end(), scene.layers.begin(), scene.layers.end());
+        scene.record.emitterFirst = static_cast<uint32_t>(outEmitters.size());
+        scene.record.emitterCount = static_cast<uint32_t>(scene.emitters.size());
+        outEmitters.insert(outEmitters.end(), scene.emitters.begin(), scene.emitters.end());
+        scene.record.imageFirst = static_cast<uint32_t>(outImages.size());
+        scene.record.imageCount = static_cast<uint32_t>(scene.images.size());
+        outImages.insert(outImages.end(), scene.images.begin(), scene.images.end());
+        outScenes.push_back(scene.record);
+    }
+
+    for (auto &node : nodes)
+    {
+        node.record.choiceFirst = static_cast<uint32_t>(outChoices.size());
+        node.record.choiceCount = static_cast<uint32_t>(node.choices.size());
+        for (auto &choice : node.choices)
+        {
+            resolveNode(choice.record.nextNode, choice.line, "choice leads to");
+            if (!choice.startQuest.empty() && questIds.count(choice.startQuest) == 0)
+            {
+                Fail(choice.line, "choice starts unknown quest '" + choice.startQuest + "'");
+            }
+            outChoices.push_back(choice.record);
+        }
+        outNodes.push_back(node.record);
+    }
+
+    for (auto &quest : quests)
+    {
+        quest.record.objectiveFirst = static_cast<uint32_t>(outObjectives.size());
+        quest.record.objectiveCount = static_cast<uint32_t>(quest.objectives.size());
+        for (auto &objective : quest.objectives)
+        {
+            objective.first.flagFirst = static_cast<uint32_t>(outObjectiveFlags.size());
+            objective.first.flagCount = static_cast<uint32_t>(objective.second.size());
+            outObjectiveFlags.insert(outObjectiveFlags.end(), objective.second.begin(), objective.second.end());
+            outObjectives.push_back(objective.first);
+        }
+        outQuests.push_back(quest.record);
+    }
+
+    for (const auto &event : events)
+    {
+        if (!event.scene.empty() && sceneIds.count(event.scene) == 0)
+        {
+            Fail(event.line, "event targets unknown scene '" + event.scene + "'");
+        }
+        outEvents.push_back(event.record);
+    }
+
+    // Nothing else sets flags at runtime, so a tested flag without a setter
+    // is a typo: its condition would never hold, or always hold if negated.
+    for (uint32_t id = 0; id < flags.size(); ++id)
+    {
+        if (flagReadAt[id] != 0 && flagWritten[id] == 0u)
+        {
+            const std::string name = blob.substr(flags[id].offset, flags[id].length);
+            Fail(flagReadAt[id], "flag '" + name + "' is tested but no choice sets it and no event grants it");
+        }
+    }
+
+    return !failed;
+}
+
+template <typename T>
+static void AppendSection(std::string &out, PackHeader &header, PackSectionId id, const T *records, size_t count)
+{
+    while (out.size() % 4u != 0u)
+    {
+        out.push_back('\0');
+    }
+    PackSection &section = header.sections[static_cast<size_t>(id)];
+    section.offset = static_cast<uint32_t>(out.size());
+    section.count = static_cast<uint32_t>(count);
+    out.append(reinterpret_cast<const char *>(records), count * sizeof(T));
+}
+
+bool PackBuilder::Write(const std::string &outPath) const
+{
+    PackHeader header{};
+    std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+    header.version = kPackVersion;
+    header.sectionCount = static_cast<uint32_t>(kPackSectionCount);
+
+    std::string out(sizeof(PackHeader), '\0');
+    AppendSection(out, header, PackSectionId::Strings, blob.data(), blob.size());
+    AppendSection(out, header, PackSectionId::Flags, flags.data(), flags.size());
+    AppendSection(out, header, PackSectionId::Scenes, outScenes.data(), outScenes.size());
+    AppendSection(out, header, PackSectionId::Points, outPoints.data(), outPoints.size());
+    AppendSection(out, header, PackSectionId::Rings, outRings.data(), outRings.size());
+    AppendSection(out, header, PackSectionId::Hotspots, outHotspots.data(), outHotspots.size());
+    AppendSection(out, header, PackSectionId::Nodes, outNodes.data(), outNodes.size());
+    AppendSection(out, header, PackSectionId::Choices, outChoices.data(), outChoices.size());
+    AppendSection(out, header, PackSectionId::Quests, outQuests.data(), outQuests.size());
+    AppendSection(out, header, PackSectionId::Objectives, outObjectives.data(), outObjectives.size());
+    AppendSection(out, header, PackSectionId::ObjectiveFlags, outObjectiveFlags.data(), outObjectiveFlags.size());
+    AppendSection(out, header, PackSectionId::Events, outEvents.data(), outEvents.size());
+    AppendSection(out, header, PackSectionId::Rules, rules.data(), rules.size());
+    AppendSection(out, header, PackSectionId::Reasons, reasons.data(), reasons.size());
+    AppendSection(out, header, PackSectionId::Pillars, pillars.data(), pillars.size());
+    AppendSection(out, header, PackSectionId::Layers, outLayers.data(), outLayers.size());
+    AppendSection(out, header, PackSectionId::Emitters, outEmitters.data(), outEmitters.size());
+    AppendSection(out, header, PackSectionId::Images, outImages.data(), outImages.size());
+    AppendSection(out, header, PackSectionId::MaskBits, outMaskBits.data(), outMaskBits.size());
+    AppendSection(out, header, PackSectionId::Conditions, outConditions.data(), outConditions.size());
+    header.fileSize = static_cast<uint32_t>(out.size());
+    std::memcpy(&out[0], &header, sizeof(PackHeader));
+
+    const std::string tempPath = outPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(out.data(), static_cast<std::streamsize>(out.size())))
+        {
+            std::fprintf(stderr, "error: cannot write %s\n", tempPath.c_str());
+            return false;
+        }
+    }
+    std::remove(outPath.c_str());
+    if (std::rename(tempPath.c_str(), outPath.c_str()) != 0)
+    {
+        std::fprintf(stderr, "error: cannot move %s into place\n", tempPath.c_str());
+        return false;
+    }
+
+    std::printf("worldforge_pack: %zu scenes, %zu nodes, %zu choices, %zu flags, %zu bytes -> %s\n",
+                outScenes.size(), outNodes.size(), outChoices.size(), flags.size(), out.size(), outPath.c_str());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "usage: %s <source.wfc> <output.pack>\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in)
+    {
+        std::fprintf(stderr, "error: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+
+    PackBuilder builder(argv[1]);
+    if (!builder.Parse(text.str()) || !builder.Resolve() || !builder.Write(argv[2]))
+    {
+        return 1;
+    }
+    return 0;
+}